@@ -76,7 +76,8 @@ void SourceFileImplOggVorbis::init()
 		callbacks.tell_func = tellFn;
 
 		int status = ov_open_callbacks( this, &mOggVorbisFile, NULL, 0, callbacks );
-		CI_ASSERT( status == 0 );
+		if( status )
+			throw AudioFileExc( string( "Failed to open Ogg Vorbis stream with error: " ), (int32_t)status );
 	}
 
 	vorbis_info *info = ov_info( &mOggVorbisFile, -1 );
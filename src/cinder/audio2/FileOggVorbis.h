@@ -50,6 +50,9 @@ class SourceFileImplOggVorbis : public SourceFile {
 	void		performSeek( size_t readPositionFrames )											override;
 	std::string getMetaData() const																	override;
 
+	//! Returns the DataSource this file is decoded from.
+	const DataSourceRef& getDataSource() const	{ return mDataSource; }
+
   private:
 	void init();
 
@@ -22,6 +22,9 @@
  */
 
 #include "cinder/audio2/Filter.h"
+#include "cinder/audio2/CinderAssert.h"
+
+#include "cinder/CinderMath.h"
 
 using namespace std;
 
@@ -32,16 +35,15 @@ void FilterBiquad::initialize()
 	// Convert from Hertz to normalized frequency 0 -> 1.
 	mNiquist = getSampleRate() / 2;
 
-	mBufferd = BufferT<double>( getFramesPerBlock(), mNumChannels );
-	mBiquads.resize( mNumChannels );
+	mBiquadBank.setNumFilters( mNumChannels );
 
-	if( mCoeffsDirty )
-		updateBiquadParams();
+	// the bank was reset to pass-thru, so coefficients need to be reapplied regardless of mCoeffsDirty
+	updateBiquadParams();
 }
 
 void FilterBiquad::uninitialize()
 {
-	mBiquads.clear();
+	mBiquadBank.setNumFilters( 0 );
 }
 
 void FilterBiquad::process( Buffer *buffer )
@@ -49,12 +51,8 @@ void FilterBiquad::process( Buffer *buffer )
 	if( mCoeffsDirty )
 		updateBiquadParams();
 
-	size_t numFrames = buffer->getNumFrames();
-
-	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
-		float *channel = buffer->getChannel( ch );
-		mBiquads[ch].process( channel, channel, numFrames );
-	}
+	mBiquadBank.setPrecision( mDoublePrecision ? dsp::BiquadBank::DOUBLE : dsp::BiquadBank::FLOAT );
+	mBiquadBank.process( buffer );
 }
 
 void FilterBiquad::updateBiquadParams()
@@ -64,41 +62,363 @@ void FilterBiquad::updateBiquadParams()
 
 	switch( mMode ) {
 		case Mode::LOWPASS:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setLowpassParams( normalizedFrequency, mQ );
+			mBiquad.setLowpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::HIGHPASS:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setHighpassParams( normalizedFrequency, mQ );
+			mBiquad.setHighpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::BANDPASS:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setBandpassParams( normalizedFrequency, mQ );
+			mBiquad.setBandpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::LOWSHELF:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setLowShelfParams( mFreq, mGain );;
+			mBiquad.setLowShelfParams( mFreq, mGain );;
 			break;
 		case Mode::HIGHSHELF:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setHighShelfParams( mFreq, mGain );;
+			mBiquad.setHighShelfParams( mFreq, mGain );;
 			break;
 		case Mode::PEAKING:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setPeakingParams( normalizedFrequency, mQ, mGain );
+			mBiquad.setPeakingParams( normalizedFrequency, mQ, mGain );
 			break;
 		case Mode::ALLPASS:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setBandpassParams( normalizedFrequency, mQ );
+			mBiquad.setBandpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::NOTCH:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setNotchParams( normalizedFrequency, mQ );
+			mBiquad.setNotchParams( normalizedFrequency, mQ );
 			break;
 		default:
 			break;
 	}
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ )
+		mBiquadBank.setCoefficients( ch, mBiquad );
+}
+
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FilterEq
+// ----------------------------------------------------------------------------------------------------
+
+FilterEq::FilterEq( size_t numBands, const Format &format )
+: NodeEffect( format ), mCoeffsDirty( true )
+{
+	Band band = { FilterBiquad::PEAKING, 1000.0f, 1.0f, 0.0f };
+	mBands.resize( numBands, band );
+}
+
+void FilterEq::setBand( size_t band, Mode mode, float freq, float q, float gain )
+{
+	Band &b = mBands.at( band );
+	b.mMode = mode;
+	b.mFreq = freq;
+	b.mQ = q;
+	b.mGain = gain;
+	mCoeffsDirty = true;
+}
+
+void FilterEq::setBandMode( size_t band, Mode mode )
+{
+	mBands.at( band ).mMode = mode;
+	mCoeffsDirty = true;
+}
+
+void FilterEq::setBandFreq( size_t band, float freq )
+{
+	mBands.at( band ).mFreq = freq;
+	mCoeffsDirty = true;
+}
+
+void FilterEq::setBandQ( size_t band, float q )
+{
+	mBands.at( band ).mQ = q;
+	mCoeffsDirty = true;
+}
+
+void FilterEq::setBandGain( size_t band, float gain )
+{
+	mBands.at( band ).mGain = gain;
+	mCoeffsDirty = true;
+}
+
+void FilterEq::initialize()
+{
+	mState.assign( mNumChannels * mBands.size() * 2, 0 );
+	mTargetCoeffs.resize( mBands.size() );
+
+	// start at the current settings without a crossfade
+	updateTargetCoeffs();
+	mCoeffs = mTargetCoeffs;
+	mCoeffsDirty = false;
+}
+
+void FilterEq::updateTargetCoeffs()
+{
+	const double nyquist = getSampleRate() / 2.0;
+
+	for( size_t i = 0; i < mBands.size(); i++ ) {
+		const Band &band = mBands[i];
+		const double normalizedFrequency = band.mFreq / nyquist;
+		Coeffs &coeffs = mTargetCoeffs[i];
+
+		switch( band.mMode ) {
+			case FilterBiquad::LOWPASS:		mBiquad.setLowpassParams( normalizedFrequency, band.mQ ); break;
+			case FilterBiquad::HIGHPASS:	mBiquad.setHighpassParams( normalizedFrequency, band.mQ ); break;
+			case FilterBiquad::BANDPASS:	mBiquad.setBandpassParams( normalizedFrequency, band.mQ ); break;
+			case FilterBiquad::LOWSHELF:	mBiquad.setLowShelfParams( normalizedFrequency, band.mGain ); break;
+			case FilterBiquad::HIGHSHELF:	mBiquad.setHighShelfParams( normalizedFrequency, band.mGain ); break;
+			case FilterBiquad::PEAKING:		mBiquad.setPeakingParams( normalizedFrequency, band.mQ, band.mGain ); break;
+			case FilterBiquad::ALLPASS:		mBiquad.setAllpassParams( normalizedFrequency, band.mQ ); break;
+			case FilterBiquad::NOTCH:		mBiquad.setNotchParams( normalizedFrequency, band.mQ ); break;
+			default:
+				// modes without a design (CUSTOM) pass the band through, rather than reusing the previous band's coefficients
+				coeffs.b0 = 1;
+				coeffs.b1 = coeffs.b2 = coeffs.a1 = coeffs.a2 = 0;
+				continue;
+		}
+
+		double b0, b1, b2, a1, a2;
+		mBiquad.getCoefficients( &b0, &b1, &b2, &a1, &a2 );
+
+		coeffs.b0 = (float)b0;
+		coeffs.b1 = (float)b1;
+		coeffs.b2 = (float)b2;
+		coeffs.a1 = (float)a1;
+		coeffs.a2 = (float)a2;
+	}
+}
+
+// Each sample is passed through the whole cascade before moving on to the next, so it stays in a register instead of making one pass
+// over the channel per band. Each section's state is two floats, which for any reasonable number of bands stays in L1.
+void FilterEq::process( Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t numBands = mBands.size();
+
+	if( ! mCoeffsDirty ) {
+		const Coeffs *coeffs = mCoeffs.data();
+
+		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+			float *channel = buffer->getChannel( ch );
+			float *state = &mState[ch * numBands * 2];
+
+			for( size_t i = 0; i < numFrames; i++ ) {
+				float x = channel[i];
+				for( size_t b = 0; b < numBands; b++ ) {
+					const Coeffs &c = coeffs[b];
+					float *s = state + b * 2;
+					const float y = c.b0 * x + s[0];
+					s[0] = c.b1 * x - c.a1 * y + s[1];
+					s[1] = c.b2 * x - c.a2 * y;
+					x = y;
+				}
+				channel[i] = x;
+			}
+		}
+
+		return;
+	}
+
+	mCoeffsDirty = false;
+	updateTargetCoeffs();
+
+	// crossfade all coefficients from their current to their target values over this block
+	const float rampIncr = 1.0f / (float)numFrames;
+	const Coeffs *begin = mCoeffs.data();
+	const Coeffs *end = mTargetCoeffs.data();
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		float *channel = buffer->getChannel( ch );
+		float *state = &mState[ch * numBands * 2];
+
+		for( size_t i = 0; i < numFrames; i++ ) {
+			const float t = ( i + 1 ) * rampIncr;
+			float x = channel[i];
+			for( size_t b = 0; b < numBands; b++ ) {
+				const Coeffs &c0 = begin[b];
+				const Coeffs &c1 = end[b];
+				float *s = state + b * 2;
+				const float y = ( c0.b0 + ( c1.b0 - c0.b0 ) * t ) * x + s[0];
+				s[0] = ( c0.b1 + ( c1.b1 - c0.b1 ) * t ) * x - ( c0.a1 + ( c1.a1 - c0.a1 ) * t ) * y + s[1];
+				s[1] = ( c0.b2 + ( c1.b2 - c0.b2 ) * t ) * x - ( c0.a2 + ( c1.a2 - c0.a2 ) * t ) * y;
+				x = y;
+			}
+			channel[i] = x;
+		}
+	}
+
+	copy( mTargetCoeffs.begin(), mTargetCoeffs.end(), mCoeffs.begin() );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FilterSvf
+// ----------------------------------------------------------------------------------------------------
+
+namespace {
+
+const float kMinCutoffFreq = 1.0f;
+const float kMaxCutoffRatio = 0.49f;	// of samplerate, keeps tan() well away from its pole
+const float kMinResonance = 0.025f;
+
+// [5/4] Pade approximant of tan(x), relative error below 3e-4 for x in [0, 0.49 * pi].
+inline float tanApprox( float x )
+{
+	const float x2 = x * x;
+	return x * ( 945.0f + x2 * ( -105.0f + x2 ) ) / ( 945.0f + x2 * ( -420.0f + x2 * 15.0f ) );
 }
 
+// Output is mixed from the input and both integrator states as: m0 * v0 + ( m1 + m1k * k ) * v1 + m2 * v2
+struct SvfMix {
+	float m0, m1, m1k, m2;
+};
+
+SvfMix getSvfMix( FilterSvf::Mode mode )
+{
+	switch( mode ) {
+		case FilterSvf::LOWPASS:	return { 0, 0, 0, 1 };
+		case FilterSvf::HIGHPASS:	return { 1, 0, -1, -1 };
+		case FilterSvf::BANDPASS:	return { 0, 1, 0, 0 };
+		case FilterSvf::NOTCH:		return { 1, 0, -1, 0 };
+		case FilterSvf::PEAK:		return { 1, 0, -1, -2 };
+		case FilterSvf::ALLPASS:	return { 1, 0, -2, 0 };
+		default:					CI_ASSERT_NOT_REACHABLE();
+	}
+
+	return { 1, 0, 0, 0 };
+}
+
+} // anonymous namespace
+
+FilterSvf::FilterSvf( Mode mode, const Format &format )
+: NodeEffect( format ), mCutoffFreq( this, 200 ), mResonance( this, 0.707f ), mMode( mode ), mCoeffPeriod( 16 )
+{
+}
+
+void FilterSvf::setCoeffPeriod( size_t frames )
+{
+	CI_ASSERT( frames > 0 );
+
+	mCoeffPeriod = frames;
+}
+
+void FilterSvf::initialize()
+{
+	mState.assign( mNumChannels, State() );
+	mCoeffBuffer = Buffer( getFramesPerBlock(), 4 );
+}
+
+FilterSvf::Coeffs FilterSvf::calcCoeffs( float freq, float q ) const
+{
+	const float sampleRate = (float)getSampleRate();
+	freq = math<float>::clamp( freq, kMinCutoffFreq, sampleRate * kMaxCutoffRatio );
+
+	Coeffs result;
+	result.g = tanApprox( float( M_PI ) * freq / sampleRate );
+	result.k = 1.0f / max( q, kMinResonance );
+	return result;
+}
+
+void FilterSvf::fillCoeffBuffer( const float *freqArray, const float *qArray, size_t numFrames )
+{
+	const float freqConst = mCutoffFreq.getValue();
+	const float qConst = mResonance.getValue();
+
+	float *a1 = mCoeffBuffer.getChannel( 0 );
+	float *a2 = mCoeffBuffer.getChannel( 1 );
+	float *a3 = mCoeffBuffer.getChannel( 2 );
+	float *k = mCoeffBuffer.getChannel( 3 );
+
+	Coeffs begin = calcCoeffs( freqArray ? freqArray[0] : freqConst, qArray ? qArray[0] : qConst );
+	for( size_t frame = 0; frame < numFrames; ) {
+		const size_t segmentEnd = min( frame + mCoeffPeriod, numFrames );
+		const size_t target = min( segmentEnd, numFrames - 1 );
+		const Coeffs end = calcCoeffs( freqArray ? freqArray[target] : freqConst, qArray ? qArray[target] : qConst );
+
+		const float segmentLength = float( segmentEnd - frame );
+		const float gIncr = ( end.g - begin.g ) / segmentLength;
+		const float kIncr = ( end.k - begin.k ) / segmentLength;
+
+		float g = begin.g;
+		float kk = begin.k;
+		for( size_t i = frame; i < segmentEnd; i++ ) {
+			a1[i] = 1.0f / ( 1.0f + g * ( g + kk ) );
+			a2[i] = g * a1[i];
+			a3[i] = g * a2[i];
+			k[i] = kk;
+
+			g += gIncr;
+			kk += kIncr;
+		}
+
+		begin = end;
+		frame = segmentEnd;
+	}
+}
+
+void FilterSvf::process( Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+	const SvfMix mix = getSvfMix( mMode );
+
+	const bool freqVarying = mCutoffFreq.eval();
+	const bool qVarying = mResonance.eval();
+
+	if( ! freqVarying && ! qVarying ) {
+		const Coeffs coeffs = calcCoeffs( mCutoffFreq.getValue(), mResonance.getValue() );
+		const float g = coeffs.g;
+		const float k = coeffs.k;
+		const float a1 = 1.0f / ( 1.0f + g * ( g + k ) );
+		const float a2 = g * a1;
+		const float a3 = g * a2;
+		const float m1 = mix.m1 + mix.m1k * k;
+
+		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+			float *channel = buffer->getChannel( ch );
+			float ic1eq = mState[ch].ic1eq;
+			float ic2eq = mState[ch].ic2eq;
+
+			for( size_t i = 0; i < numFrames; i++ ) {
+				const float v0 = channel[i];
+				const float v3 = v0 - ic2eq;
+				const float v1 = a1 * ic1eq + a2 * v3;
+				const float v2 = ic2eq + a2 * ic1eq + a3 * v3;
+				ic1eq = 2 * v1 - ic1eq;
+				ic2eq = 2 * v2 - ic2eq;
+
+				channel[i] = mix.m0 * v0 + m1 * v1 + mix.m2 * v2;
+			}
+
+			mState[ch].ic1eq = ic1eq;
+			mState[ch].ic2eq = ic2eq;
+		}
+
+		return;
+	}
+
+	fillCoeffBuffer( freqVarying ? mCutoffFreq.getValueArray() : nullptr, qVarying ? mResonance.getValueArray() : nullptr, numFrames );
+
+	const float *a1 = mCoeffBuffer.getChannel( 0 );
+	const float *a2 = mCoeffBuffer.getChannel( 1 );
+	const float *a3 = mCoeffBuffer.getChannel( 2 );
+	const float *k = mCoeffBuffer.getChannel( 3 );
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		float *channel = buffer->getChannel( ch );
+		float ic1eq = mState[ch].ic1eq;
+		float ic2eq = mState[ch].ic2eq;
+
+		for( size_t i = 0; i < numFrames; i++ ) {
+			const float v0 = channel[i];
+			const float v3 = v0 - ic2eq;
+			const float v1 = a1[i] * ic1eq + a2[i] * v3;
+			const float v2 = ic2eq + a2[i] * ic1eq + a3[i] * v3;
+			ic1eq = 2 * v1 - ic1eq;
+			ic2eq = 2 * v2 - ic2eq;
+
+			channel[i] = mix.m0 * v0 + ( mix.m1 + mix.m1k * k[i] ) * v1 + mix.m2 * v2;
+		}
+
+		mState[ch].ic1eq = ic1eq;
+		mState[ch].ic2eq = ic2eq;
+	}
+}
 
 } } // namespace cinder::audio2
\ No newline at end of file
@@ -25,6 +25,7 @@
 
 #include "cinder/audio2/NodeEffect.h"
 #include "cinder/audio2/dsp/Biquad.h"
+#include "cinder/audio2/dsp/BiquadBank.h"
 
 #include <vector>
 
@@ -37,13 +38,15 @@ namespace cinder { namespace audio2 {
 typedef std::shared_ptr<class FilterLowPass>		FilterLowPassRef;
 typedef std::shared_ptr<class FilterHighPass>		FilterHighPassRef;
 typedef std::shared_ptr<class FilterBandPass>		FilterBandPassRef;
+typedef std::shared_ptr<class FilterEq>			FilterEqRef;
+typedef std::shared_ptr<class FilterSvf>			FilterSvfRef;
 
-//! Base class for filter nodes that use Biquad
+//! Base class for filter nodes that use Biquad. All channels are processed together by a dsp::BiquadBank.
 class FilterBiquad : public NodeEffect {
   public:
 	enum Mode { LOWPASS, HIGHPASS, BANDPASS, LOWSHELF, HIGHSHELF, PEAKING, ALLPASS, NOTCH, CUSTOM };
 
-	FilterBiquad( Mode mode = LOWPASS, const Format &format = Format() ) : NodeEffect( format ), mMode( mode ), mCoeffsDirty( true ), mFreq( 200.0f ), mQ( 1.0f ), mGain( 0.0f ) {}
+	FilterBiquad( Mode mode = LOWPASS, const Format &format = Format() ) : NodeEffect( format ), mMode( mode ), mCoeffsDirty( true ), mDoublePrecision( true ), mFreq( 200.0f ), mQ( 1.0f ), mGain( 0.0f ) {}
 	virtual ~FilterBiquad() {}
 
 	void setMode( Mode mode )	{ mMode = mode; mCoeffsDirty = true; }
@@ -58,6 +61,10 @@ class FilterBiquad : public NodeEffect {
 	void setGain( float gain )	{ mGain = gain; mCoeffsDirty = true; }
 	float getGain() const		{ return mGain; }
 
+	//! Enables filter state to be kept in double precision, which reduces rounding noise for very low cutoff frequencies at some cost in speed. Default is enabled.
+	void enableDoublePrecision( bool enable = true )	{ mDoublePrecision = enable; }
+	bool isDoublePrecisionEnabled() const				{ return mDoublePrecision; }
+
   protected:
 	void initialize()				override;
 	void uninitialize()				override;
@@ -65,9 +72,9 @@ class FilterBiquad : public NodeEffect {
 
 	void updateBiquadParams();
 
-	std::vector<dsp::Biquad> mBiquads;
-	std::atomic<bool> mCoeffsDirty;
-	BufferT<double> mBufferd;
+	dsp::Biquad mBiquad;			// designs the coefficients shared by all channels
+	dsp::BiquadBank mBiquadBank;
+	std::atomic<bool> mCoeffsDirty, mDoublePrecision;
 	size_t mNiquist;
 
 	Mode mMode;
@@ -110,5 +117,109 @@ public:
 	float getWidth() const			{ return mQ; }
 };
 
+//! \brief Multi-band equalizer that runs a cascade of biquad sections per sample in a single pass over each channel.
+//!
+//! Each band is a biquad section configured like FilterBiquad (mode, frequency, Q and gain) and defaults to a flat PEAKING band. When a band
+//! changes, the coefficients of every section are linearly crossfaded from their old to their new values over the next processing block,
+//! avoiding the discontinuities caused by stepping coefficients.
+class FilterEq : public NodeEffect {
+  public:
+	typedef FilterBiquad::Mode Mode;
+
+	//! Constructs a FilterEq with \a numBands bands, which is fixed for the lifetime of the Node.
+	FilterEq( size_t numBands, const Format &format = Format() );
+	virtual ~FilterEq() {}
+
+	size_t getNumBands() const		{ return mBands.size(); }
+
+	//! Sets all parameters of band \a band. \a freq is in hertz and \a gain is in decibels (used by the shelving and peaking modes).
+	void setBand( size_t band, Mode mode, float freq, float q, float gain = 0 );
+
+	void setBandMode( size_t band, Mode mode );
+	Mode getBandMode( size_t band ) const		{ return mBands.at( band ).mMode; }
+
+	void setBandFreq( size_t band, float freq );
+	float getBandFreq( size_t band ) const		{ return mBands.at( band ).mFreq; }
+
+	void setBandQ( size_t band, float q );
+	float getBandQ( size_t band ) const			{ return mBands.at( band ).mQ; }
+
+	void setBandGain( size_t band, float gain );
+	float getBandGain( size_t band ) const		{ return mBands.at( band ).mGain; }
+
+  protected:
+	void initialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	struct Band {
+		Mode	mMode;
+		float	mFreq, mQ, mGain;
+	};
+	//! Normalized coefficients of one transposed direct form II section.
+	struct Coeffs {
+		float b0, b1, b2, a1, a2;
+	};
+
+	void updateTargetCoeffs();
+
+	std::vector<Band>	mBands;
+	std::vector<Coeffs>	mCoeffs, mTargetCoeffs;
+	std::vector<float>	mState;			// two per band, per channel
+	std::atomic<bool>	mCoeffsDirty;
+	dsp::Biquad			mBiquad;		// used to design each band's coefficients
+};
+
+//! \brief State variable filter using the topology-preserving transform (trapezoidal integration), suitable for audio rate modulation.
+//!
+//! Cutoff frequency and resonance are Param's, and can be ramped or driven by a processor at any Param::EvalRate. While either is varying,
+//! coefficients are computed once every getCoeffPeriod() samples (using a rational tan approximation) and linearly interpolated for the samples
+//! in between, so sweeps are free of zipper noise while the per-sample cost stays a handful of multiply-adds.
+class FilterSvf : public NodeEffect {
+  public:
+	enum Mode { LOWPASS, HIGHPASS, BANDPASS, NOTCH, PEAK, ALLPASS };
+
+	FilterSvf( Mode mode = LOWPASS, const Format &format = Format() );
+	virtual ~FilterSvf() {}
+
+	void setMode( Mode mode )				{ mMode = mode; }
+	Mode getMode() const					{ return mMode; }
+
+	//! Sets the cutoff (or center) frequency in hertz. It is clamped to just below nyquist during processing.
+	void setCutoffFreq( float freq )		{ mCutoffFreq.setValue( freq ); }
+	float getCutoffFreq() const				{ return mCutoffFreq.getValue(); }
+	//! Sets the resonance as Q, where 0.707 is a maximally flat response and higher values produce a resonant peak. Default is 0.707.
+	void setResonance( float q )			{ mResonance.setValue( q ); }
+	float getResonance() const				{ return mResonance.getValue(); }
+
+	Param* getParamCutoffFreq()				{ return &mCutoffFreq; }
+	Param* getParamResonance()				{ return &mResonance; }
+
+	//! Sets the number of samples between coefficient computations while the cutoff or resonance is varying. Default is 16.
+	void	setCoeffPeriod( size_t frames );
+	size_t	getCoeffPeriod() const			{ return mCoeffPeriod; }
+
+  protected:
+	void initialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	struct Coeffs {
+		float g, k;
+	};
+	struct State {
+		float ic1eq, ic2eq;
+	};
+
+	Coeffs	calcCoeffs( float freq, float q ) const;
+	void	fillCoeffBuffer( const float *freqArray, const float *qArray, size_t numFrames );
+
+	Param				mCutoffFreq, mResonance;
+	Mode				mMode;
+	size_t				mCoeffPeriod;
+	std::vector<State>	mState;
+	Buffer				mCoeffBuffer;	// per-sample a1, a2, a3 and k, shared by all channels
+};
+
 
 } } // namespace cinder::audio2
\ No newline at end of file
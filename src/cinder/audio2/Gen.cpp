@@ -26,7 +26,8 @@
 #include "cinder/audio2/dsp/Dsp.h"
 #include "cinder/audio2/Utilities.h"
 #include "cinder/audio2/Debug.h"
-#include "cinder/Rand.h"
+
+#include <future>
 
 #define DEFAULT_TABLE_SIZE 4096
 #define DEFAULT_BANDLIMITED_TABLES 40
@@ -35,6 +36,67 @@ using namespace std;
 
 namespace cinder { namespace audio2 {
 
+namespace {
+
+// Returns the shared bandlimited table set for \a type, keeping the dimensions of \a current if there is one.
+dsp::WaveTable2dRef getCachedWaveTable( const dsp::WaveTable2dRef &current, WaveformType type, size_t sampleRate )
+{
+	size_t tableSize = current ? current->getTableSize() : DEFAULT_TABLE_SIZE;
+	size_t numTables = current ? current->getNumTables() : DEFAULT_BANDLIMITED_TABLES;
+
+	return dsp::WaveTableCache::getBandlimited( type, sampleRate, tableSize, numTables );
+}
+
+// splitmix32 style hash, used to expand a seed into the xorshift128 state of all of GenNoise's lanes
+uint32_t nextSeedHash( uint32_t &seed )
+{
+	uint32_t z = ( seed += 0x9E3779B9 );
+	z = ( z ^ ( z >> 16 ) ) * 0x85EBCA6B;
+	z = ( z ^ ( z >> 13 ) ) * 0xC2B2AE35;
+	return z ^ ( z >> 16 );
+}
+
+// Maps the upper 23 bits of \a r to a float in [-1:1), by way of the mantissa of a float in [1:2).
+inline float toNoiseSample( uint32_t r )
+{
+	union { uint32_t i; float f; } bits;
+	bits.i = ( r >> 9 ) | 0x3F800000;
+	return bits.f * 2 - 3;
+}
+
+// 2-point polynomial approximation of the band-limited step's residual, for a step of height 2 at \a t = 0. \a t is the phase
+// in [0:1) and \a dt the (positive) phase increment per sample, so only the samples on either side of the step are corrected.
+inline float polyBlep( float t, float dt )
+{
+	if( t < dt ) {
+		t /= dt;
+		return t + t - t * t - 1;
+	}
+	else if( t > 1 - dt ) {
+		t = ( t - 1 ) / dt;
+		return t * t + t + t + 1;
+	}
+
+	return 0;
+}
+
+// Integral of polyBlep(), which corrects the change of slope at \a t = 0 rather than a step.
+inline float polyBlamp( float t, float dt )
+{
+	if( t < dt ) {
+		t = t / dt - 1;
+		return t * t * t * ( -1.0f / 3.0f );
+	}
+	else if( t > 1 - dt ) {
+		t = ( t - 1 ) / dt + 1;
+		return t * t * t * ( 1.0f / 3.0f );
+	}
+
+	return 0;
+}
+
+} // anonymous namespace
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - Gen
 // ----------------------------------------------------------------------------------------------------
@@ -66,13 +128,122 @@ void Gen::initialize()
 // MARK: - GenNoise
 // ----------------------------------------------------------------------------------------------------
 
+GenNoise::GenNoise( const Format &format )
+	: Gen( format ), mColor( Color::WHITE ), mSeedChanged( false )
+{
+	static atomic<uint32_t> sDefaultSeed( 0 );
+	mSeed = sDefaultSeed++;
+	applySeed( mSeed );
+}
+
+void GenNoise::setSeed( uint32_t seed )
+{
+	mSeed = seed;
+	mSeedChanged = true;
+}
+
+void GenNoise::applySeed( uint32_t seed )
+{
+	for( size_t i = 0; i < NUM_LANES; i++ ) {
+		mStateX[i] = nextSeedHash( seed );
+		mStateY[i] = nextSeedHash( seed );
+		mStateZ[i] = nextSeedHash( seed );
+		mStateW[i] = nextSeedHash( seed );
+
+		// an all zero state would only ever produce zeros
+		if( ! ( mStateX[i] | mStateY[i] | mStateZ[i] | mStateW[i] ) )
+			mStateX[i] = 1;
+	}
+
+	fill( mPinkState, mPinkState + 7, 0.0f );
+	mBrownState = 0;
+}
+
 void GenNoise::process( Buffer *buffer )
 {
+	if( mSeedChanged.exchange( false ) )
+		applySeed( mSeed );
+
 	float *data = buffer->getData();
-	size_t count = buffer->getSize();
+	const size_t count = buffer->getSize();
+
+	fillWhite( data, count );
+
+	switch( mColor.load() ) {
+		case Color::WHITE:
+			break;
+		case Color::PINK: {
+			float b0 = mPinkState[0], b1 = mPinkState[1], b2 = mPinkState[2], b3 = mPinkState[3], b4 = mPinkState[4], b5 = mPinkState[5], b6 = mPinkState[6];
+			for( size_t i = 0; i < count; i++ ) {
+				const float white = data[i];
+				b0 = 0.99886f * b0 + white * 0.0555179f;
+				b1 = 0.99332f * b1 + white * 0.0750759f;
+				b2 = 0.96900f * b2 + white * 0.1538520f;
+				b3 = 0.86650f * b3 + white * 0.3104856f;
+				b4 = 0.55000f * b4 + white * 0.5329522f;
+				b5 = -0.7616f * b5 - white * 0.0168980f;
+				data[i] = ( b0 + b1 + b2 + b3 + b4 + b5 + b6 + white * 0.5362f ) * 0.11f; // scaled to roughly [-1:1]
+				b6 = white * 0.115926f;
+			}
+			mPinkState[0] = b0; mPinkState[1] = b1; mPinkState[2] = b2; mPinkState[3] = b3; mPinkState[4] = b4; mPinkState[5] = b5; mPinkState[6] = b6;
+			break;
+		}
+		case Color::BROWN: {
+			float brown = mBrownState;
+			for( size_t i = 0; i < count; i++ ) {
+				brown = ( brown + 0.02f * data[i] ) * ( 1.0f / 1.02f );
+				data[i] = brown * 3.5f; // scaled to roughly [-1:1]
+			}
+			mBrownState = brown;
+			break;
+		}
+	}
+}
+
+// Each step advances all lanes once and writes one sample per lane, so a block's samples are interleaved across lanes. The SSE
+// and scalar paths produce identical samples. A partial step at the end of the block only advances the first lanes.
+void GenNoise::fillWhite( float *data, size_t count )
+{
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	for( size_t lane = 0; lane < NUM_LANES; lane += 4 ) {
+		__m128i x = _mm_loadu_si128( (const __m128i *)&mStateX[lane] );
+		__m128i y = _mm_loadu_si128( (const __m128i *)&mStateY[lane] );
+		__m128i z = _mm_loadu_si128( (const __m128i *)&mStateZ[lane] );
+		__m128i w = _mm_loadu_si128( (const __m128i *)&mStateW[lane] );
+
+		const __m128i floatOne = _mm_set1_epi32( 0x3F800000 );
+		for( size_t step = 0; step + NUM_LANES <= count; step += NUM_LANES ) {
+			const __m128i t = _mm_xor_si128( x, _mm_slli_epi32( x, 11 ) );
+			x = y;
+			y = z;
+			z = w;
+			w = _mm_xor_si128( _mm_xor_si128( w, _mm_srli_epi32( w, 19 ) ), _mm_xor_si128( t, _mm_srli_epi32( t, 8 ) ) );
+
+			const __m128 sample = _mm_castsi128_ps( _mm_or_si128( _mm_srli_epi32( w, 9 ), floatOne ) );
+			_mm_storeu_ps( data + step + lane, _mm_sub_ps( _mm_add_ps( sample, sample ), _mm_set1_ps( 3 ) ) );
+		}
+
+		_mm_storeu_si128( (__m128i *)&mStateX[lane], x );
+		_mm_storeu_si128( (__m128i *)&mStateY[lane], y );
+		_mm_storeu_si128( (__m128i *)&mStateZ[lane], z );
+		_mm_storeu_si128( (__m128i *)&mStateW[lane], w );
+	}
+
+	i = count - count % NUM_LANES;
+#endif
 
-	for( size_t i = 0; i < count; i++ )
-		data[i] = ci::randFloat( -1.0f, 1.0f );
+	for( ; i < count; i++ ) {
+		const size_t lane = i % NUM_LANES;
+		const uint32_t t = mStateX[lane] ^ ( mStateX[lane] << 11 );
+		mStateX[lane] = mStateY[lane];
+		mStateY[lane] = mStateZ[lane];
+		mStateZ[lane] = mStateW[lane];
+		mStateW[lane] = mStateW[lane] ^ ( mStateW[lane] >> 19 ) ^ t ^ ( t >> 8 );
+
+		data[i] = toNoiseSample( mStateW[lane] );
+	}
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -83,25 +254,14 @@ void GenSine::process( Buffer *buffer )
 {
 	float *data = buffer->getData();
 	const size_t count = buffer->getSize();
-	const float samplePeriod = mSamplePeriod;
-	float phase = mPhase;
 
 	if( mFreq.eval() ) {
-		const float *freqValues = mFreq.getValueArray();
-		for( size_t i = 0; i < count; i++ ) {
-			data[i] = math<float>::sin( phase * float( 2 * M_PI ) );
-			phase = wrap( phase + freqValues[i] * samplePeriod );
-		}
-	}
-	else {
-		const float phaseIncr = mFreq.getValue() * samplePeriod;
-		for( size_t i = 0; i < count; i++ ) {
-			data[i] = math<float>::sin( phase * float( 2 * M_PI ) );
-			phase = wrap( phase + phaseIncr );
-		}
+		// the phase increments are computed in place, which dsp::sine() supports
+		dsp::mul( mFreq.getValueArray(), mSamplePeriod, data, count );
+		mPhase = dsp::sine( data, count, mPhase, data );
 	}
-
-	mPhase = phase;
+	else
+		mPhase = dsp::sine( data, count, mPhase, mFreq.getValue() * mSamplePeriod );
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -211,52 +371,200 @@ void GenTable::process( Buffer *buffer )
 // ----------------------------------------------------------------------------------------------------
 
 GenOscillator::GenOscillator( const Format &format )
-	: Gen( format ), mWaveformType( format.getWaveform() )
+	: Gen( format ), mWaveformType( format.getWaveform() ), mBandlimitMode( format.getBandlimitMode() ), mAsyncWaveTable( new AsyncWaveTable ),
+		mWidth( this, 0.5f )
 {
 }
 
 GenOscillator::GenOscillator( float freq, const Format &format )
-	: Gen( freq, format ), mWaveformType( format.getWaveform() )
+	: Gen( freq, format ), mWaveformType( format.getWaveform() ), mBandlimitMode( format.getBandlimitMode() ), mAsyncWaveTable( new AsyncWaveTable ),
+		mWidth( this, 0.5f )
 {
 }
 
+GenOscillator::~GenOscillator()
+{
+	if( mAsyncFill.valid() )
+		mAsyncFill.wait();
+}
+
 void GenOscillator::initialize()
 {
 	Gen::initialize();
 
-	size_t sampleRate = getSampleRate();
-	bool needsFill = false;
-	if( ! mWaveTable ) {
-		mWaveTable.reset( new dsp::WaveTable2d( sampleRate, DEFAULT_TABLE_SIZE, DEFAULT_BANDLIMITED_TABLES ) );
-		needsFill = true;
+	if( mBandlimitMode == BandlimitMode::POLY_BLEP ) {
+		mPhaseIncrBuffer.setNumFrames( getFramesPerBlock() );
+		return;
 	}
-	else if( sampleRate != mWaveTable->getSampleRate() )
-		needsFill = true;
 
-	if( needsFill )
-		mWaveTable->fillBandlimited( mWaveformType );
+	size_t sampleRate = getSampleRate();
+	if( ! mWaveTable || sampleRate != mWaveTable->getSampleRate() ) {
+		// discard any table set still being filled for the previous samplerate
+		lock_guard<mutex> lock( mAsyncWaveTable->mMutex );
+		mAsyncWaveTable->mRequestId++;
+		mAsyncWaveTable->mReady = false;
+
+		mWaveTable = getCachedWaveTable( mWaveTable, mWaveformType, sampleRate );
+	}
 }
 
-void GenOscillator::setWaveform( WaveformType type )
+void GenOscillator::setWaveform( WaveformType type, bool async )
 {
 	if( mWaveformType == type )
 		return;
 
-	// TODO: to prevent the entire graph from blocking, use our own lock and tryLock / fail when blocked in process()
-	lock_guard<mutex> lock( getContext()->getMutex() );
-
 	mWaveformType = type;
-	mWaveTable->fillBandlimited( type );
+
+	if( mBandlimitMode == BandlimitMode::POLY_BLEP )
+		return;
+
+	size_t sampleRate, tableSize, numTables, requestId;
+	{
+		// a newer request invalidates any table that is still being filled, or that process() hasn't yet picked up
+		lock_guard<mutex> lock( mAsyncWaveTable->mMutex );
+		requestId = ++mAsyncWaveTable->mRequestId;
+		mAsyncWaveTable->mReady = false;
+
+		// if not yet initialized, the table will be fetched in initialize()
+		if( ! mWaveTable )
+			return;
+
+		sampleRate = mWaveTable->getSampleRate();
+		tableSize = mWaveTable->getTableSize();
+		numTables = mWaveTable->getNumTables();
+
+		if( async ) {
+			mAsyncWaveTable->mFillRequestId = requestId;
+			mAsyncWaveTable->mType = type;
+			mAsyncWaveTable->mSampleRate = sampleRate;
+			mAsyncWaveTable->mTableSize = tableSize;
+			mAsyncWaveTable->mNumTables = numTables;
+
+			// a fill that is still running picks up this request when it finishes
+			if( mAsyncWaveTable->mFilling )
+				return;
+
+			mAsyncWaveTable->mFilling = true;
+		}
+	}
+
+	if( async ) {
+		// the previous fill has already cleared mFilling, so this only waits for its thread to exit
+		mAsyncFill = std::async( launch::async, &GenOscillator::fillAsyncWaveTable, mAsyncWaveTable );
+	}
+	else {
+		// the shared table set is fetched (or filled) without blocking the audio thread, only the pointer swap happens under the context lock
+		dsp::WaveTable2dRef waveTable = dsp::WaveTableCache::getBandlimited( type, sampleRate, tableSize, numTables );
+		{
+			lock_guard<mutex> lock( getContext()->getMutex() );
+			swap( mWaveTable, waveTable );
+		}
+	}
+}
+
+void GenOscillator::fillAsyncWaveTable( const shared_ptr<AsyncWaveTable> &asyncWaveTable )
+{
+	unique_lock<mutex> lock( asyncWaveTable->mMutex );
+
+	while( true ) {
+		const size_t requestId = asyncWaveTable->mFillRequestId;
+		const WaveformType type = asyncWaveTable->mType;
+		const size_t sampleRate = asyncWaveTable->mSampleRate;
+		const size_t tableSize = asyncWaveTable->mTableSize;
+		const size_t numTables = asyncWaveTable->mNumTables;
+
+		lock.unlock();
+		dsp::WaveTable2dRef waveTable = dsp::WaveTableCache::getBandlimited( type, sampleRate, tableSize, numTables );
+		lock.lock();
+
+		if( asyncWaveTable->mRequestId == requestId ) {
+			asyncWaveTable->mWaveTable = waveTable;
+			asyncWaveTable->mReady = true;
+			break;
+		}
+
+		// fill again only if there is a newer asynchronous request, otherwise this one was superseded by a synchronous request or re-initialization
+		if( asyncWaveTable->mFillRequestId == requestId )
+			break;
+	}
+
+	asyncWaveTable->mFilling = false;
 }
 
 void GenOscillator::process( Buffer *buffer )
 {
+	if( mBandlimitMode == BandlimitMode::POLY_BLEP ) {
+		processPolyBlep( buffer );
+		return;
+	}
+
+	// pick up a table set filled on a background thread, if the lock is contended it will be tried again next block
+	if( mAsyncWaveTable->mReady && mAsyncWaveTable->mMutex.try_lock() ) {
+		if( mAsyncWaveTable->mReady ) {
+			swap( mWaveTable, mAsyncWaveTable->mWaveTable );
+			mAsyncWaveTable->mReady = false;
+		}
+		mAsyncWaveTable->mMutex.unlock();
+	}
+
 	if( mFreq.eval() )
 		mPhase = mWaveTable->lookupBandlimited( buffer->getData(), buffer->getSize(), mPhase, mFreq.getValueArray() );
 	else
 		mPhase = mWaveTable->lookupBandlimited( buffer->getData(), buffer->getSize(), mPhase, mFreq.getValue() );
 }
 
+// Each waveform is rendered naively, then the samples on either side of a discontinuity are corrected with polyBlep() (or
+// polyBlamp() for the triangle's corners). The polarity and phase of each waveform match the wavetable versions.
+void GenOscillator::processPolyBlep( Buffer *buffer )
+{
+	float *data = buffer->getData();
+	const size_t count = buffer->getSize();
+	float *phaseIncrArray = mPhaseIncrBuffer.getData();
+	float phase = mPhase;
+
+	if( mFreq.eval() )
+		dsp::mul( mFreq.getValueArray(), mSamplePeriod, phaseIncrArray, count );
+	else
+		dsp::fill( mFreq.getValue() * mSamplePeriod, phaseIncrArray, count );
+
+	switch( mWaveformType.load() ) {
+		case WaveformType::SINE:
+			phase = dsp::sine( data, count, phase, phaseIncrArray );
+			break;
+		case WaveformType::SAWTOOTH:
+			for( size_t i = 0; i < count; i++ ) {
+				data[i] = 1 - 2 * phase + polyBlep( phase, fabsf( phaseIncrArray[i] ) );
+				phase = wrap( phase + phaseIncrArray[i] );
+			}
+			break;
+		case WaveformType::SQUARE: {
+			const bool widthVaries = mWidth.eval();
+			const float *widthArray = widthVaries ? mWidth.getValueArray() : nullptr;
+			const float widthValue = math<float>::clamp( mWidth.getValue() );
+
+			for( size_t i = 0; i < count; i++ ) {
+				const float width = widthVaries ? math<float>::clamp( widthArray[i] ) : widthValue;
+				const float dt = fabsf( phaseIncrArray[i] );
+
+				data[i] = ( phase < width ? 1.0f : -1.0f ) + polyBlep( phase, dt ) - polyBlep( wrap( phase - width ), dt );
+				phase = wrap( phase + phaseIncrArray[i] );
+			}
+			break;
+		}
+		case WaveformType::TRIANGLE:
+			for( size_t i = 0; i < count; i++ ) {
+				const float dt = fabsf( phaseIncrArray[i] );
+				const float t = wrap( phase + 0.25f ); // corners at t = 0 and t = 0.5
+
+				data[i] = 1 - 4 * fabsf( t - 0.5f ) + 4 * dt * ( polyBlamp( t, dt ) - polyBlamp( wrap( t - 0.5f ), dt ) );
+				phase = wrap( phase + phaseIncrArray[i] );
+			}
+			break;
+	}
+
+	mPhase = phase;
+}
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - GenPulse
 // ----------------------------------------------------------------------------------------------------
@@ -278,16 +586,8 @@ void GenPulse::initialize()
 	mBuffer2.setNumFrames( getFramesPerBlock() );
 
 	size_t sampleRate = getSampleRate();
-	bool needsFill = false;
-	if( ! mWaveTable ) {
-		mWaveTable.reset( new dsp::WaveTable2d( sampleRate, DEFAULT_TABLE_SIZE, DEFAULT_BANDLIMITED_TABLES ) );
-		needsFill = true;
-	}
-	else if( sampleRate != mWaveTable->getSampleRate() )
-		needsFill = true;
-
-	if( needsFill )
-		mWaveTable->fillBandlimited( WaveformType::SAWTOOTH );
+	if( ! mWaveTable || sampleRate != mWaveTable->getSampleRate() )
+		mWaveTable = getCachedWaveTable( mWaveTable, WaveformType::SAWTOOTH, sampleRate );
 }
 
 void GenPulse::process( Buffer *buffer )
@@ -347,4 +647,267 @@ void GenPulse::process( Buffer *buffer )
 	dsp::sub( buffer->getData(), mBuffer2.getData(), buffer->getData(), buffer->getSize() );
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - GenBank
+// ----------------------------------------------------------------------------------------------------
+
+GenBank::GenBank( size_t numOscillators, const Format &format )
+	: NodeInput( format ), mNumOscillators( numOscillators ), mSampleRate( 0 ), mSamplePeriod( 0 ),
+		mUserFreqs( numOscillators, 0 ), mUserGains( numOscillators, 0 ), mCommandQueue( max<size_t>( numOscillators * 2, 64 ) )
+{
+	mChannelMode = ChannelMode::SPECIFIED;
+	setNumChannels( 1 );
+
+	const size_t paddedSize = ( numOscillators + 3 ) & ~size_t( 3 );
+
+	mPhases.resize( paddedSize, 0 );
+	mPhaseIncrs.resize( paddedSize, 0 );
+	mPhaseIncrDeltas.resize( paddedSize, 0 );
+	mPhaseIncrTargets.resize( paddedSize, 0 );
+	mFreqRampFrames.resize( paddedSize, 0 );
+	mFreqTargets.resize( paddedSize, 0 );
+	mGains.resize( paddedSize, 0 );
+	mGainDeltas.resize( paddedSize, 0 );
+	mGainTargets.resize( paddedSize, 0 );
+	mGainRampFrames.resize( paddedSize, 0 );
+}
+
+void GenBank::initialize()
+{
+	mSampleRate = (float)getSampleRate();
+	mSamplePeriod = 1.0f / mSampleRate;
+	mAccumBuffer.resize( getFramesPerBlock() * 4 );
+
+	// phase increments depend on the samplerate, so recompute them and jump to the target frequencies
+	for( size_t i = 0; i < mNumOscillators; i++ ) {
+		mPhaseIncrTargets[i] = mPhaseIncrs[i] = toPhaseIncr( mFreqTargets[i] );
+		mFreqRampFrames[i] = 0;
+	}
+}
+
+void GenBank::setFreq( size_t index, float freq, float rampSeconds )
+{
+	CI_ASSERT( index < mNumOscillators );
+
+	lock_guard<mutex> lock( mCommandMutex );
+	mUserFreqs[index] = freq;
+	pushCommand( CommandType::FREQ, index, freq, rampSeconds );
+}
+
+void GenBank::setGain( size_t index, float gain, float rampSeconds )
+{
+	CI_ASSERT( index < mNumOscillators );
+
+	lock_guard<mutex> lock( mCommandMutex );
+	mUserGains[index] = gain;
+	pushCommand( CommandType::GAIN, index, gain, rampSeconds );
+}
+
+void GenBank::setPhase( size_t index, float phase )
+{
+	CI_ASSERT( index < mNumOscillators );
+
+	lock_guard<mutex> lock( mCommandMutex );
+	pushCommand( CommandType::PHASE, index, phase, 0 );
+}
+
+float GenBank::getFreq( size_t index ) const
+{
+	CI_ASSERT( index < mNumOscillators );
+
+	lock_guard<mutex> lock( mCommandMutex );
+	return mUserFreqs[index];
+}
+
+float GenBank::getGain( size_t index ) const
+{
+	CI_ASSERT( index < mNumOscillators );
+
+	lock_guard<mutex> lock( mCommandMutex );
+	return mUserGains[index];
+}
+
+void GenBank::pushCommand( CommandType type, size_t index, float value, float rampSeconds )
+{
+	const Command command = { type, index, value, rampSeconds };
+	mCommandQueue.push( command, getContext()->getMutex(), [this] { processCommands(); } );
+}
+
+void GenBank::processCommands()
+{
+	Command command;
+	while( mCommandQueue.pop( &command ) ) {
+
+		const size_t i = command.mIndex;
+		const int32_t rampFrames = int32_t( command.mRampSeconds * mSampleRate );
+
+		switch( command.mType ) {
+			case CommandType::FREQ:
+				mFreqTargets[i] = command.mValue;
+				mPhaseIncrTargets[i] = toPhaseIncr( command.mValue );
+				if( rampFrames > 0 ) {
+					// the starting increment absorbs the delta's rounding error, so that the ramp ends exactly on the target
+					mPhaseIncrDeltas[i] = int32_t( ( int64_t( mPhaseIncrTargets[i] ) - int64_t( mPhaseIncrs[i] ) ) / rampFrames );
+					mPhaseIncrs[i] = int32_t( int64_t( mPhaseIncrTargets[i] ) - int64_t( mPhaseIncrDeltas[i] ) * rampFrames );
+				}
+				else
+					mPhaseIncrs[i] = mPhaseIncrTargets[i];
+
+				mFreqRampFrames[i] = max( rampFrames, 0 );
+				break;
+			case CommandType::GAIN:
+				mGainTargets[i] = command.mValue;
+				if( rampFrames > 0 )
+					mGainDeltas[i] = ( command.mValue - mGains[i] ) / float( rampFrames );
+				else
+					mGains[i] = command.mValue;
+
+				mGainRampFrames[i] = max( rampFrames, 0 );
+				break;
+			case CommandType::PHASE:
+				mPhases[i] = uint32_t( int64_t( double( wrap( command.mValue ) ) * 4294967296.0 ) );
+				break;
+		}
+	}
+}
+
+int32_t GenBank::toPhaseIncr( float freq ) const
+{
+	// frequencies at or above nyquist are clamped just below it so that the increment doesn't overflow
+	const double cycles = math<double>::clamp( double( freq ) * double( mSamplePeriod ), -0.5, 0.4999999 );
+	return int32_t( cycles * 4294967296.0 );
+}
+
+void GenBank::process( Buffer *buffer )
+{
+	processCommands();
+	renderOscillators( buffer->getData(), buffer->getSize() );
+	finishRamps();
+}
+
+#if defined( CINDER_AUDIO_SSE )
+
+// Each group of four oscillators is accumulated into an interleaved buffer with one partial sum per lane, ramps are advanced
+// with per-lane masks that stop counting at zero. The lanes are summed into the output once all groups are rendered.
+void GenBank::renderOscillators( float *data, size_t count )
+{
+	float *accum = mAccumBuffer.data();
+	memset( accum, 0, count * 4 * sizeof( float ) );
+
+	const __m128i zero = _mm_setzero_si128();
+
+	for( size_t g = 0; g < mPhases.size(); g += 4 ) {
+		__m128i phase = _mm_loadu_si128( (const __m128i *)&mPhases[g] );
+		__m128i incr = _mm_loadu_si128( (const __m128i *)&mPhaseIncrs[g] );
+		__m128i freqFrames = _mm_loadu_si128( (const __m128i *)&mFreqRampFrames[g] );
+		__m128 gain = _mm_loadu_ps( &mGains[g] );
+		__m128i gainFrames = _mm_loadu_si128( (const __m128i *)&mGainRampFrames[g] );
+
+		// silent groups with no ramps only need their phases advanced
+		const int silent = _mm_movemask_ps( _mm_cmpeq_ps( gain, _mm_setzero_ps() ) ) == 0xF
+							&& _mm_movemask_epi8( _mm_cmpeq_epi32( _mm_or_si128( freqFrames, gainFrames ), zero ) ) == 0xFFFF;
+		if( silent ) {
+			for( size_t k = 0; k < 4; k++ )
+				mPhases[g + k] += uint32_t( mPhaseIncrs[g + k] ) * uint32_t( count );
+			continue;
+		}
+
+		const __m128i incrDelta = _mm_loadu_si128( (const __m128i *)&mPhaseIncrDeltas[g] );
+		const __m128 gainDelta = _mm_loadu_ps( &mGainDeltas[g] );
+
+		for( size_t i = 0; i < count; i++ ) {
+			float *frameAccum = accum + i * 4;
+			_mm_storeu_ps( frameAccum, _mm_add_ps( _mm_loadu_ps( frameAccum ), _mm_mul_ps( gain, dsp::sinFixedPhase( phase ) ) ) );
+
+			phase = _mm_add_epi32( phase, incr );
+
+			// active lanes are all ones (-1), so adding the mask counts the remaining ramp frames down
+			const __m128i freqActive = _mm_cmpgt_epi32( freqFrames, zero );
+			incr = _mm_add_epi32( incr, _mm_and_si128( freqActive, incrDelta ) );
+			freqFrames = _mm_add_epi32( freqFrames, freqActive );
+
+			const __m128i gainActive = _mm_cmpgt_epi32( gainFrames, zero );
+			gain = _mm_add_ps( gain, _mm_and_ps( _mm_castsi128_ps( gainActive ), gainDelta ) );
+			gainFrames = _mm_add_epi32( gainFrames, gainActive );
+		}
+
+		_mm_storeu_si128( (__m128i *)&mPhases[g], phase );
+		_mm_storeu_si128( (__m128i *)&mPhaseIncrs[g], incr );
+		_mm_storeu_si128( (__m128i *)&mFreqRampFrames[g], freqFrames );
+		_mm_storeu_ps( &mGains[g], gain );
+		_mm_storeu_si128( (__m128i *)&mGainRampFrames[g], gainFrames );
+	}
+
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 row0 = _mm_loadu_ps( accum + i * 4 );
+		__m128 row1 = _mm_loadu_ps( accum + i * 4 + 4 );
+		__m128 row2 = _mm_loadu_ps( accum + i * 4 + 8 );
+		__m128 row3 = _mm_loadu_ps( accum + i * 4 + 12 );
+		_MM_TRANSPOSE4_PS( row0, row1, row2, row3 );
+
+		_mm_storeu_ps( data + i, _mm_add_ps( _mm_add_ps( row0, row1 ), _mm_add_ps( row2, row3 ) ) );
+	}
+	for( ; i < count; i++ ) {
+		const float *frameAccum = accum + i * 4;
+		data[i] = ( frameAccum[0] + frameAccum[1] ) + ( frameAccum[2] + frameAccum[3] );
+	}
+}
+
+#else
+
+void GenBank::renderOscillators( float *data, size_t count )
+{
+	memset( data, 0, count * sizeof( float ) );
+
+	for( size_t k = 0; k < mNumOscillators; k++ ) {
+		uint32_t phase = mPhases[k];
+		int32_t incr = mPhaseIncrs[k];
+		int32_t freqFrames = mFreqRampFrames[k];
+		float gain = mGains[k];
+		int32_t gainFrames = mGainRampFrames[k];
+
+		if( gain == 0 && ! freqFrames && ! gainFrames ) {
+			mPhases[k] = phase + uint32_t( incr ) * uint32_t( count );
+			continue;
+		}
+
+		const int32_t incrDelta = mPhaseIncrDeltas[k];
+		const float gainDelta = mGainDeltas[k];
+
+		for( size_t i = 0; i < count; i++ ) {
+			data[i] += gain * dsp::sinFixedPhase( phase );
+			phase += uint32_t( incr );
+
+			if( freqFrames ) {
+				incr += incrDelta;
+				freqFrames--;
+			}
+			if( gainFrames ) {
+				gain += gainDelta;
+				gainFrames--;
+			}
+		}
+
+		mPhases[k] = phase;
+		mPhaseIncrs[k] = incr;
+		mFreqRampFrames[k] = freqFrames;
+		mGains[k] = gain;
+		mGainRampFrames[k] = gainFrames;
+	}
+}
+
+#endif // defined( CINDER_AUDIO_SSE )
+
+// Ramps accumulate rounding error from their per-frame deltas, so they land exactly on their targets once complete.
+void GenBank::finishRamps()
+{
+	for( size_t k = 0; k < mNumOscillators; k++ ) {
+		if( ! mFreqRampFrames[k] )
+			mPhaseIncrs[k] = mPhaseIncrTargets[k];
+		if( ! mGainRampFrames[k] )
+			mGains[k] = mGainTargets[k];
+	}
+}
+
 } } // namespace cinder::audio2
\ No newline at end of file
@@ -25,12 +25,19 @@
 
 #include "cinder/audio2/NodeInput.h"
 #include "cinder/audio2/dsp/WaveTable.h"
+#include "cinder/audio2/dsp/RingBuffer.h"
+
+#include <future>
+#include <mutex>
+#include <vector>
+#include <cstdint>
 
 namespace cinder { namespace audio2 {
 
 typedef std::shared_ptr<class Gen>						GenRef;
 typedef std::shared_ptr<class GenOscillator>			GenOscillatorRef;
 typedef std::shared_ptr<class GenPulse>					GenPulseRef;
+typedef std::shared_ptr<class GenBank>					GenBankRef;
 
 //! Base class for NodeInput's that generate audio samples.
 class Gen : public NodeInput {
@@ -53,13 +60,44 @@ class Gen : public NodeInput {
 	float mPhase;
 };
 
-//! Noise generator. \note freq param is ignored
+//! Noise generator, using a xorshift128 random number generator per node that produces eight samples per step. \note freq param is ignored
 class GenNoise : public Gen {
   public:
-	GenNoise( const Format &format = Format() ) : Gen( format ) {}
+	//! Spectral shape of the noise.
+	enum class Color {
+		//! Flat spectrum.
+		WHITE,
+		//! -3dB per octave, white noise filtered with a parallel bank of one-pole lowpass filters (Paul Kellet's method, designed for 44.1kHz).
+		PINK,
+		//! -6dB per octave, white noise filtered with a leaky integrator.
+		BROWN
+	};
+
+	//! Constructs a GenNoise with a seed that differs from all other GenNoise's.
+	GenNoise( const Format &format = Format() );
+
+	void	setColor( Color color )		{ mColor = color; }
+	Color	getColor() const			{ return mColor; }
+
+	//! Re-seeds the random number generator and clears the filter state, so that the same samples are produced each time (e.g. for offline rendering).
+	//! Takes effect at the beginning of the next processing block.
+	void	setSeed( uint32_t seed );
+
+	//! The number of samples generated per step, each by an independent generator.
+	static const size_t NUM_LANES = 8;
 
   protected:
 	void process( Buffer *buffer ) override;
+
+	void applySeed( uint32_t seed );
+	void fillWhite( float *data, size_t count );
+
+	// xorshift128 state of each lane, in structure-of-arrays layout
+	uint32_t				mStateX[NUM_LANES], mStateY[NUM_LANES], mStateZ[NUM_LANES], mStateW[NUM_LANES];
+	float					mPinkState[7], mBrownState;
+	std::atomic<Color>		mColor;
+	std::atomic<uint32_t>	mSeed;
+	std::atomic<bool>		mSeedChanged;
 };
 
 //! Phase generator, i.e. ramping waveform that runs from 0 to 1.
@@ -117,40 +155,90 @@ class GenTable : public Gen {
 	dsp::WaveTableRef	mWaveTable;
 };
 
-//! General purpose, band-limited oscillator using wavetable lookup.
+//! General purpose, band-limited oscillator using wavetable lookup (default) or table-free polyBLEP correction.
 class GenOscillator : public Gen {
   public:
+	//! Method used to band-limit the waveform.
+	enum class BandlimitMode {
+		//! Lookup into a set of band-limited tables, shared with other oscillators through dsp::WaveTableCache.
+		WAVETABLE,
+		//! Naive waveforms with their discontinuities smoothed by polynomial residuals (polyBLEP, and polyBLAMP for triangle), computed per sample without any tables.
+		POLY_BLEP
+	};
 
 	struct Format : public Node::Format {
-		Format() : mWaveformType( WaveformType::SINE )	{}
+		Format() : mWaveformType( WaveformType::SINE ), mBandlimitMode( BandlimitMode::WAVETABLE )	{}
 
-		Format&		waveform( WaveformType type )	{ mWaveformType = type; return *this; }
+		Format&		waveform( WaveformType type )			{ mWaveformType = type; return *this; }
+		Format&		bandlimitMode( BandlimitMode mode )		{ mBandlimitMode = mode; return *this; }
 
-		const WaveformType& getWaveform() const	{ return mWaveformType; }
+		const WaveformType& getWaveform() const			{ return mWaveformType; }
+		BandlimitMode		getBandlimitMode() const	{ return mBandlimitMode; }
 
       private:
-		WaveformType mWaveformType;
+		WaveformType	mWaveformType;
+		BandlimitMode	mBandlimitMode;
 	};
 
 	GenOscillator( const Format &format = Format() );
 	GenOscillator( float freq, const Format &format = Format() );
+	//! Waits for a table set that is still being filled by setWaveform( type, true ).
+	virtual ~GenOscillator();
 
+	//! Sets the waveform. The table set is fetched from dsp::WaveTableCache (and filled if necessary) without holding the Context's lock, only swapping it into place blocks the audio thread.
+	//! If \a async is true, this happens on a background thread and the audio thread switches to the new table set once it is ready, so this method returns immediately.
+	//! Each oscillator fills at most one table set at a time, requests made while one is being filled are picked up by the same thread when it finishes.
+	//! With BandlimitMode::POLY_BLEP there are no tables and the waveform changes on the next processed block.
+	void setWaveform( WaveformType type, bool async = false );
 
-	void setWaveform( WaveformType type );
-
+	//! Sets the table set used for lookup. By default, a table set shared with all other oscillators of the same waveform and samplerate is used (see dsp::WaveTableCache).
 	void setWaveTable( const dsp::WaveTable2dRef &waveTable )	{ mWaveTable = waveTable; }
+	//! Returns the table set used for lookup. \note It may be shared with other oscillators and should not be modified.
 	const dsp::WaveTable2dRef getWaveTable() const				{ return mWaveTable; }
 
 	WaveformType	getWaveForm() const			{ return mWaveformType; }
-	size_t			getTableSize() const		{ return mWaveTable->getTableSize(); }
+	//! Returns the size of each table in the table set, or 0 if there is none (BandlimitMode::POLY_BLEP, or before initialization).
+	size_t			getTableSize() const		{ return mWaveTable ? mWaveTable->getTableSize() : 0; }
+	BandlimitMode	getBandlimitMode() const	{ return mBandlimitMode; }
+
+	//! Sets the pulse width (aka 'duty cycle') of the square waveform. Expected range is between [0:1] (default = 0.5). \note Only used with BandlimitMode::POLY_BLEP, see GenPulse otherwise.
+	void	setWidth( float width )	{ mWidth.setValue( width ); }
+	//! Get the current pulse width. \see setWidth()
+	float	getWidth() const		{ return mWidth.getValue(); }
+	//! Returns the Param associated with the pulse width. \see setWidth()
+	Param*	getParamWidth()			{ return &mWidth; }
 
   protected:
 	void initialize() override;
 	void process( Buffer *buffer ) override;
 
+	void processPolyBlep( Buffer *buffer );
 
-	dsp::WaveTable2dRef		mWaveTable;
-	WaveformType			mWaveformType;
+	//! Table set filled on a background thread by setWaveform( type, true ), which process() swaps with mWaveTable once mReady is set.
+	//! The table that is swapped out is left here so that it is released on a non-audio thread.
+	struct AsyncWaveTable {
+		AsyncWaveTable() : mReady( false ), mRequestId( 0 ), mFillRequestId( 0 ), mFilling( false ) {}
+
+		std::mutex				mMutex;
+		dsp::WaveTable2dRef		mWaveTable;
+		std::atomic<bool>		mReady;
+		size_t					mRequestId;
+
+		// parameters of the latest asynchronous request, read by the fill thread
+		size_t					mFillRequestId, mSampleRate, mTableSize, mNumTables;
+		WaveformType			mType;
+		bool					mFilling;
+	};
+
+	static void fillAsyncWaveTable( const std::shared_ptr<AsyncWaveTable> &asyncWaveTable );
+
+	dsp::WaveTable2dRef				mWaveTable;
+	std::atomic<WaveformType>		mWaveformType;
+	const BandlimitMode				mBandlimitMode;
+	std::shared_ptr<AsyncWaveTable>	mAsyncWaveTable;
+	Param							mWidth;
+	BufferDynamic					mPhaseIncrBuffer;
+	std::future<void>				mAsyncFill;
 };
 
 //! Pulse waveform generator with variable pulse width. Based on wavetable lookup of two band-limited sawtooth waveforms, subtracted from each other.
@@ -175,4 +263,62 @@ class GenPulse : public Gen {
 	Param					mWidth;
 };
 
+//! Bank of sine oscillators that are rendered and summed into a single output channel. The oscillators are stored in
+//! structure-of-arrays layout and processed four at a time, which is far cheaper than connecting one GenSine per partial.
+//! Each oscillator's frequency and gain can be ramped linearly and independently of the others.
+class GenBank : public NodeInput {
+  public:
+	//! Constructs a GenBank with \a numOscillators oscillators, which are all silent (gain = 0) until setGain() is called.
+	GenBank( size_t numOscillators, const Format &format = Format() );
+
+	//! Returns the number of oscillators, fixed at construction.
+	size_t	getNumOscillators() const	{ return mNumOscillators; }
+
+	//! Sets the frequency of oscillator \a index to \a freq, ramping linearly over \a rampSeconds (0 = immediately).
+	void	setFreq( size_t index, float freq, float rampSeconds = 0 );
+	//! Sets the gain of oscillator \a index to \a gain, ramping linearly over \a rampSeconds (0 = immediately).
+	void	setGain( size_t index, float gain, float rampSeconds = 0 );
+	//! Resets the phase of oscillator \a index to \a phase, expected range is [0:1).
+	void	setPhase( size_t index, float phase );
+
+	//! Returns the last frequency set for oscillator \a index, which it may still be ramping towards.
+	float	getFreq( size_t index ) const;
+	//! Returns the last gain set for oscillator \a index, which it may still be ramping towards.
+	float	getGain( size_t index ) const;
+
+  protected:
+	void initialize() override;
+	void process( Buffer *buffer ) override;
+
+  private:
+	enum class CommandType { FREQ, GAIN, PHASE };
+
+	struct Command {
+		CommandType	mType;
+		size_t		mIndex;
+		float		mValue, mRampSeconds;
+	};
+
+	void	pushCommand( CommandType type, size_t index, float value, float rampSeconds );
+	void	processCommands();
+	void	renderOscillators( float *data, size_t count );
+	void	finishRamps();
+	int32_t	toPhaseIncr( float freq ) const;
+
+	size_t		mNumOscillators;
+	float		mSampleRate, mSamplePeriod;
+
+	// user thread
+	std::vector<float>			mUserFreqs, mUserGains;
+	mutable std::mutex			mCommandMutex;	// serializes producers of mCommandQueue, never taken by the audio thread
+	dsp::CommandQueueT<Command>	mCommandQueue;
+
+	// audio thread, padded to a multiple of four oscillators. Phases and increments are fixed-point, where 2^32 is one cycle.
+	std::vector<uint32_t>		mPhases;
+	std::vector<int32_t>		mPhaseIncrs, mPhaseIncrDeltas, mPhaseIncrTargets, mFreqRampFrames;
+	std::vector<float>			mGains, mGainDeltas, mGainTargets, mFreqTargets;
+	std::vector<int32_t>		mGainRampFrames;
+	std::vector<float>			mAccumBuffer;	// interleaved partial sums, one per SIMD lane
+};
+
 } } // namespace cinder::audio2
\ No newline at end of file
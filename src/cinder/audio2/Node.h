@@ -235,6 +235,7 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	std::weak_ptr<Context>	mContext;
 	friend class Context;
 	friend class Param;
+	friend class ModulationBus;
 };
 
 //! Enable connection syntax: \code input >> output; \endcode. Connects on the first available input and output bus.  \return the connected \a output
@@ -28,54 +28,148 @@
 
 #include "cinder/CinderMath.h"
 
+#include <algorithm>
+
 using namespace std;
 
 namespace cinder { namespace audio2 {
 
+namespace {
+
+// time constant of RampType::SET_TARGET, in units of the ramp's duration
+const float SET_TARGET_RATE = 5.0f;
+
+} // anonymous namespace
+
+// The quadratic and s-curve ramps first fill array with normalized time using dsp::ramp(), then shape it in place. These loops
+// have no dependency between iterations so they are vectorized by the compiler.
+
 void rampLinear( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor = t;
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
-	}
+	const float range = valueRange.second - valueRange.first;
+	dsp::ramp( array, count, valueRange.first + range * t, range * tIncr );
 }
 
 void rampInQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
+	const float begin = valueRange.first;
+	const float range = valueRange.second - valueRange.first;
+
+	dsp::ramp( array, count, t, tIncr );
 	for( size_t i = 0; i < count; i++ ) {
-		float factor = t * t;
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
+		float x = array[i];
+		array[i] = begin + range * x * x;
 	}
 }
 
 void rampOutQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
+	const float begin = valueRange.first;
+	const float range = valueRange.second - valueRange.first;
+
+	dsp::ramp( array, count, t, tIncr );
 	for( size_t i = 0; i < count; i++ ) {
-		float factor = -t * ( t - 2 );
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
+		float x = array[i];
+		array[i] = begin + range * x * ( 2 - x );
 	}
 }
 
-Ramp::Ramp( float timeBegin, float timeEnd, float valueBegin, float valueEnd, const RampFn &rampFn )
-	: mTimeBegin( timeBegin ), mTimeEnd( timeEnd ), mDuration( timeEnd - timeBegin ),
-	mValueBegin( valueBegin ), mValueEnd( valueEnd ), mRampFn( rampFn ), mIsComplete( false ), mIsCanceled( false )
+void rampSCurve( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
+{
+	const float begin = valueRange.first;
+	const float range = valueRange.second - valueRange.first;
+
+	dsp::ramp( array, count, t, tIncr );
+	for( size_t i = 0; i < count; i++ ) {
+		float x = array[i];
+		array[i] = begin + range * x * x * ( 3 - 2 * x );
+	}
+}
+
+void rampExponential( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
+{
+	// an exponential curve can't cross or touch zero, fall back to linear in that case.
+	if( valueRange.first * valueRange.second <= 0 ) {
+		rampLinear( array, count, t, tIncr, valueRange );
+		return;
+	}
+
+	// value = begin * ( end / begin )^t, which is a geometric series in t.
+	const double ratio = double( valueRange.second ) / double( valueRange.first );
+	dsp::rampGeometric( array, count, float( valueRange.first * pow( ratio, double( t ) ) ), float( pow( ratio, double( tIncr ) ) ) );
+}
+
+void rampSetTarget( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
+{
+	// one-pole approach: value = end + ( begin - end ) * e^( -rate * t ), normalized so the curve lands exactly on end at t = 1.
+	// e^( -rate * t ) is a geometric series in t, which is then scaled and offset into the value range.
+	const float range = valueRange.second - valueRange.first;
+	const float scale = range / ( 1 - exp( -SET_TARGET_RATE ) );
+
+	dsp::rampGeometric( array, count, exp( -SET_TARGET_RATE * t ), exp( -SET_TARGET_RATE * tIncr ) );
+	dsp::mulAdd( array, -scale, valueRange.first + scale, array, count );
+}
+
+Ramp::Ramp( uint64_t frameBegin, uint64_t frameEnd, float valueBegin, float valueEnd, size_t sampleRate, RampType rampType )
+	: mFrameBegin( frameBegin ), mFrameEnd( frameEnd ), mTimeBegin( float( double( frameBegin ) / sampleRate ) ), mTimeEnd( float( double( frameEnd ) / sampleRate ) ),
+	mValueBegin( valueBegin ), mValueEnd( valueEnd ), mRampType( rampType ), mIsComplete( false ), mIsCanceled( false ), mIsReleased( false )
 {
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ModulationBus
+// ----------------------------------------------------------------------------------------------------
+
+ModulationBus::ModulationBus( const NodeRef &processor )
+	: mProcessor( processor ), mLastRenderedFrame( 0 ), mIsRendered( false )
+{
+	CI_ASSERT( processor );
+
+	auto ctx = processor->getContext();
+	mBuffer.setNumFrames( ctx->getFramesPerBlock() );
+
+	lock_guard<mutex> lock( ctx->getMutex() );
+
+	// force node to be mono and initialize it
+	mProcessor->setNumChannels( 1 );
+	mProcessor->initializeImpl();
+}
+
+const float* ModulationBus::render()
+{
+	const uint64_t numProcessedFrames = mProcessor->getContext()->getNumProcessedFrames();
+	if( ! mIsRendered || mLastRenderedFrame != numProcessedFrames ) {
+		mIsRendered = true;
+		mLastRenderedFrame = numProcessedFrames;
+		mProcessor->pullInputs( &mBuffer );
+	}
+
+	return mBuffer.getData();
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Param
+// ----------------------------------------------------------------------------------------------------
+
 Param::Param( Node *parentNode, float initialValue )
-	: mParentNode( parentNode ), mValue( initialValue )
+	: mEventQueue( MAX_SCHEDULED_RAMPS * 2 ), mValue( initialValue ), mParentNode( parentNode ), mModulationDepth( 1 ), mModulationOffset( 0 ), mEvalRate( EvalRate::AUDIO ), mControlPeriod( 32 ),
+		mInterpolate( true ), mIsVarying( false )
 {
+	mEvents.reserve( MAX_SCHEDULED_RAMPS );
 }
 
 void Param::setValue( float value )
 {
-	lock_guard<mutex> lock( getContext()->getMutex() );
+	lock_guard<mutex> lock( mScheduleMutex );
 
-	resetImpl();
+	disconnectProcessor();
+	cancelScheduledRamps();
 	mValue = value;
+
+	Event event = {};
+	event.mType = EventType::SET_VALUE;
+	event.mValueEnd = value;
+	pushEvent( event );
 }
 
 RampRef Param::applyRamp( float valueEnd, float rampSeconds, const Options &options )
@@ -88,16 +182,16 @@ RampRef Param::applyRamp( float valueBegin, float valueEnd, float rampSeconds, c
 	initInternalBuffer();
 
 	auto ctx = getContext();
-	float timeBegin = (float)ctx->getNumProcessedSeconds() + options.getDelay();
-	float timeEnd = timeBegin + rampSeconds;
+	const size_t sampleRate = ctx->getSampleRate();
+	uint64_t frameBegin = ctx->getNumProcessedFrames() + uint64_t( options.getDelay() * sampleRate );
+	uint64_t frameEnd = frameBegin + uint64_t( rampSeconds * sampleRate );
 
-	RampRef ramp( new Ramp( timeBegin, timeEnd, valueBegin, valueEnd, options.getRampFn() ) );
-
-	lock_guard<mutex> lock( ctx->getMutex() );
-	resetImpl();
-	mRamps.push_back( ramp );
+	lock_guard<mutex> lock( mScheduleMutex );
 
-	return ramp;
+	// the APPLY_RAMP event replaces the audio thread's timeline, so there is no need to send a CLEAR event as resetImpl() would.
+	disconnectProcessor();
+	cancelScheduledRamps();
+	return scheduleRamp( EventType::APPLY_RAMP, frameBegin, frameEnd, valueBegin, valueEnd, options );
 }
 
 RampRef Param::appendRamp( float valueEnd, float rampSeconds, const Options &options )
@@ -105,17 +199,25 @@ RampRef Param::appendRamp( float valueEnd, float rampSeconds, const Options &opt
 	initInternalBuffer();
 
 	auto ctx = getContext();
-	auto endTimeAndValue = findEndTimeAndValue();
+	const size_t sampleRate = ctx->getSampleRate();
+	const uint64_t currentFrame = ctx->getNumProcessedFrames();
 
-	float timeBegin = endTimeAndValue.first + options.getDelay();
-	float timeEnd = timeBegin + rampSeconds;
+	lock_guard<mutex> lock( mScheduleMutex );
 
-	RampRef ramp( new Ramp( timeBegin, timeEnd, endTimeAndValue.second, valueEnd, options.getRampFn() ) );
+	disconnectProcessor();
 
-	lock_guard<mutex> lock( ctx->getMutex() );
-	mRamps.push_back( ramp );
+	uint64_t frameBegin = currentFrame;
+	float valueBegin = mValue;
+	const Ramp *lastRamp = findLastScheduledRamp();
+	if( lastRamp ) {
+		frameBegin = max( frameBegin, lastRamp->mFrameEnd );
+		valueBegin = lastRamp->mValueEnd;
+	}
 
-	return ramp;
+	frameBegin += uint64_t( options.getDelay() * sampleRate );
+	uint64_t frameEnd = frameBegin + uint64_t( rampSeconds * sampleRate );
+
+	return scheduleRamp( EventType::APPEND_RAMP, frameBegin, frameEnd, valueBegin, valueEnd, options );
 }
 
 void Param::setProcessor( const NodeRef &node )
@@ -125,10 +227,11 @@ void Param::setProcessor( const NodeRef &node )
 
 	initInternalBuffer();
 
-	lock_guard<mutex> lock( getContext()->getMutex() );
-
+	lock_guard<mutex> scheduleLock( mScheduleMutex );
 	resetImpl();
 
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
 	// force node to be mono and initialize it
 	node->setNumChannels( 1 );
 	node->initializeImpl();
@@ -138,43 +241,58 @@ void Param::setProcessor( const NodeRef &node )
 	CI_LOG_V( "set processing Node to: " << mProcessor->getName() );
 }
 
-void Param::reset()
+void Param::setModulation( const ModulationBusRef &bus, float depth, float offset )
 {
-	lock_guard<mutex> lock( getContext()->getMutex() );
+	if( ! bus )
+		return;
+
+	initInternalBuffer();
+
+	lock_guard<mutex> scheduleLock( mScheduleMutex );
 	resetImpl();
+
+	mModulationDepth = depth;
+	mModulationOffset = offset;
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mModulationBus = bus;
 }
 
+void Param::reset()
+{
+	lock_guard<mutex> lock( mScheduleMutex );
+	resetImpl();
+}
 
 size_t Param::getNumRamps() const
 {
-	lock_guard<mutex> lock( getContext()->getMutex() );
-	return mRamps.size();
+	lock_guard<mutex> lock( mScheduleMutex );
+
+	return countActiveRamps();
 }
 
 float Param::findDuration() const
 {
 	auto ctx = getContext();
-	lock_guard<mutex> lock( ctx->getMutex() );
+	lock_guard<mutex> lock( mScheduleMutex );
 
-	if( mRamps.empty() )
+	const Ramp *ramp = findLastScheduledRamp();
+	if( ! ramp )
 		return 0;
-	else {
-		const RampRef &ramp = mRamps.back();
-		return ramp->mTimeEnd - (float)ctx->getNumProcessedSeconds();
-	}
+	else
+		return float( double( ramp->mFrameEnd ) / ctx->getSampleRate() - ctx->getNumProcessedSeconds() );
 }
 
 pair<float, float> Param::findEndTimeAndValue() const
 {
 	auto ctx = getContext();
-	lock_guard<mutex> lock( ctx->getMutex() );
+	lock_guard<mutex> lock( mScheduleMutex );
 
-	if( mRamps.empty() )
+	const Ramp *ramp = findLastScheduledRamp();
+	if( ! ramp )
 		return make_pair( (float)ctx->getNumProcessedSeconds(), mValue.load() );
-	else {
-		const RampRef &ramp = mRamps.back();
+	else
 		return make_pair( ramp->mTimeEnd, ramp->mValueEnd );
-	}
 }
 
 const float* Param::getValueArray() const
@@ -188,92 +306,381 @@ bool Param::eval()
 {
 	if( mProcessor ) {
 		mProcessor->pullInputs( &mInternalBuffer );
+		if( mEvalRate != EvalRate::AUDIO )
+			resampleToControlRate();
+
 		mValue = mInternalBuffer[mInternalBuffer.getNumFrames() - 1]; // TODO: why not add last() ?
-		return true;
+		mIsVarying = true;
+	}
+	else if( mModulationBus ) {
+		evalModulation();
+		mIsVarying = true;
 	}
 	else {
-		auto ctx = getContext();
-		return eval( (float)ctx->getNumProcessedSeconds(), mInternalBuffer.getData(), mInternalBuffer.getSize(), ctx->getSampleRate() );
+		const uint64_t frameBegin = getContext()->getNumProcessedFrames();
+		if( mEvalRate == EvalRate::AUDIO || mInternalBuffer.isEmpty() )
+			mIsVarying = evalTimeline( frameBegin, 1, mInternalBuffer.getData(), mInternalBuffer.getNumFrames(), frameBegin + mInternalBuffer.getNumFrames() );
+		else {
+			const size_t controlPeriod = getControlPeriodForBlock();
+			const size_t numControlValues = getNumControlValues();
+			mIsVarying = evalTimeline( frameBegin, controlPeriod, mControlBuffer.getData(), numControlValues, frameBegin + mInternalBuffer.getNumFrames() );
+			if( mIsVarying )
+				fillFromControlValues();
+		}
 	}
+
+	return mIsVarying;
+}
+
+bool Param::eval( uint64_t frameBegin, float *array, size_t arrayLength )
+{
+	return evalTimeline( frameBegin, 1, array, arrayLength, frameBegin + arrayLength );
+}
+
+void Param::setEvalRate( EvalRate rate, bool interpolate )
+{
+	initInternalBuffer();
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mEvalRate = rate;
+	mInterpolate = interpolate;
+}
+
+void Param::setControlPeriod( size_t frames )
+{
+	CI_ASSERT( frames > 0 );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mControlPeriod = frames;
+}
+
+bool Param::isRamping() const
+{
+	return mProcessor || mModulationBus || ! mEvents.empty() || mEventQueue.getAvailableRead() != 0;
 }
 
-bool Param::eval( float timeBegin, float *array, size_t arrayLength, size_t sampleRate )
+const float* Param::getControlValueArray() const
 {
-	size_t samplesWritten = 0;
-	const float samplePeriod = 1.0f / (float)sampleRate;
+	CI_ASSERT( mEvalRate != EvalRate::AUDIO && ! mControlBuffer.isEmpty() );
+
+	return mControlBuffer.getData();
+}
+
+size_t Param::getNumControlValues() const
+{
+	const size_t controlPeriod = getControlPeriodForBlock();
+	return ( mInternalBuffer.getNumFrames() + controlPeriod - 1 ) / controlPeriod + 1;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Protected
+// ----------------------------------------------------------------------------------------------------
+
+// Evaluates the timeline at \a count points, spaced \a frameStride frames apart starting at \a frameBegin, into \a array.
+// frameEnd is the end of the processing block, used to decide which Ramp's have completed. Returns true if the values vary.
+bool Param::evalTimeline( uint64_t frameBegin, size_t frameStride, float *array, size_t count, uint64_t frameEnd )
+{
+	processEvents();
+
+	if( mEvents.empty() )
+		return false;
 
-	for( auto rampIt = mRamps.begin(); rampIt != mRamps.end(); /* */ ) {
-		RampRef &ramp = *rampIt;
+	bool varying = false;
+	size_t writeIndex = 0;
 
-		// first remove dead ramps
-		if( ramp->mTimeEnd < timeBegin || ramp->mIsCanceled ) {
-			rampIt = mRamps.erase( rampIt );
+	for( auto eventIt = mEvents.begin(); eventIt != mEvents.end() && writeIndex < count; /* */ ) {
+		const Event &event = *eventIt;
+
+		if( event.mRamp->mIsCanceled ) {
+			releaseEvent( event, false );
+			eventIt = mEvents.erase( eventIt );
+			continue;
+		}
+
+		// events are sorted, so if this one hasn't started yet neither have the rest.
+		if( event.mFrameBegin >= frameEnd )
+			break;
+
+		// ramps that ended before the current write position (ex. zero length or late arrivals) jump to their end value.
+		if( event.mFrameEnd <= frameBegin + writeIndex * frameStride ) {
+			mValue = event.mValueEnd;
+			releaseEvent( event, true );
+			eventIt = mEvents.erase( eventIt );
 			continue;
 		}
 
-		const float timeEnd = timeBegin + arrayLength * samplePeriod;
+		// index of the first point at or after a frame, rounded up to the frame stride.
+		auto indexForFrame = [=]( uint64_t frame ) -> size_t {
+			return frame > frameBegin ? size_t( ( frame - frameBegin + frameStride - 1 ) / frameStride ) : 0;
+		};
 
-		if( ramp->mTimeBegin < timeEnd && ramp->mTimeEnd > timeBegin ) {
-			size_t startIndex = timeBegin >= ramp->mTimeBegin ? 0 : size_t( ( ramp->mTimeBegin - timeBegin ) * sampleRate );
-			size_t endIndex = timeEnd < ramp->mTimeEnd ? arrayLength : size_t( ( ramp->mTimeEnd - timeBegin ) * sampleRate );
+		size_t startIndex = max( indexForFrame( event.mFrameBegin ), writeIndex );
+		size_t endIndex = min( indexForFrame( event.mFrameEnd ), count );
 
-			CI_ASSERT( startIndex <= arrayLength && endIndex <= arrayLength );
+		CI_ASSERT( startIndex <= endIndex && endIndex <= count );
 
-			if( startIndex > 0 && samplesWritten == 0 )
-				dsp::fill( mValue, array, startIndex );
+		// hold the current value up until the ramp begins.
+		if( startIndex > writeIndex )
+			dsp::fill( mValue, array + writeIndex, startIndex - writeIndex );
 
-			size_t count = size_t( endIndex - startIndex );
-			float timeBeginNormalized = float( timeBegin - ramp->mTimeBegin + startIndex * samplePeriod ) / ramp->mDuration;
-			float timeEndNormalized = float( timeBegin - ramp->mTimeBegin + endIndex * samplePeriod ) / ramp->mDuration;
-			float timeIncr = ( timeEndNormalized - timeBeginNormalized ) / (float)count;
+		const uint64_t duration = event.mFrameEnd - event.mFrameBegin;
+		const float tIncr = (float)frameStride / (float)duration;
+		const float t = float( double( frameBegin + startIndex * frameStride - event.mFrameBegin ) / double( duration ) );
+		renderRamp( event, array + startIndex, endIndex - startIndex, t, tIncr );
 
-			ramp->mRampFn( array + startIndex, count, timeBeginNormalized, timeIncr, make_pair( ramp->mValueBegin, ramp->mValueEnd ) );
-			samplesWritten += count;
+		varying = true;
+		writeIndex = endIndex;
 
-			// if this ramp ended with the current processing block, update mValue then remove ramp
-			if( endIndex < arrayLength ) {
-				ramp->mIsComplete = true;
-				mValue = ramp->mValueEnd;
-				rampIt = mRamps.erase( rampIt );
+		// if this ramp ended with the current processing block, update mValue then remove ramp
+		if( event.mFrameEnd <= frameEnd ) {
+			mValue = event.mValueEnd;
+			releaseEvent( event, true );
+			eventIt = mEvents.erase( eventIt );
+		}
+		else {
+			// when the stride doesn't divide the block, the last point lies past frameEnd and the ramp may end before it.
+			if( endIndex < count ) {
+				dsp::fill( event.mValueEnd, array + endIndex, count - endIndex );
+				writeIndex = count;
 			}
-			else if( samplesWritten == arrayLength ) {
-				mValue = array[arrayLength - 1];
-				break;
+
+			mValue = array[endIndex - 1];
+			break;
+		}
+	}
+
+	// hold the final value for the rest of the block, which was updated above to be the last ramp's mValueEnd.
+	if( varying && writeIndex < count )
+		dsp::fill( mValue, array + writeIndex, count - writeIndex );
+
+	return varying;
+}
+
+// Expands the control values into mInternalBuffer, either interpolating between them or holding each for a control period.
+void Param::fillFromControlValues()
+{
+	const size_t numFrames = mInternalBuffer.getNumFrames();
+	const size_t controlPeriod = getControlPeriodForBlock();
+	const float *controlValues = mControlBuffer.getData();
+	float *array = mInternalBuffer.getData();
+
+	for( size_t frame = 0, i = 0; frame < numFrames; frame += controlPeriod, i++ ) {
+		const size_t count = min( controlPeriod, numFrames - frame );
+		if( mInterpolate ) {
+			float value = controlValues[i];
+			const float incr = ( controlValues[i + 1] - value ) / (float)controlPeriod;
+			for( size_t n = 0; n < count; n++ ) {
+				array[frame + n] = value;
+				value += incr;
 			}
-			else
-				++rampIt;
 		}
 		else
-			++rampIt;
+			dsp::fill( controlValues[i], array + frame, count );
 	}
+}
 
-	// if after all ramps we still haven't written enough samples, fill with the final mValue, which was updated above to be the last ramp's mValueEnd.
-	if( samplesWritten < arrayLength )
-		dsp::fill( mValue, array + (size_t)samplesWritten, size_t( arrayLength - samplesWritten ) );
+// Decimates the processor's output to control rate, then expands it back into mInternalBuffer. The processor itself still renders at audio rate.
+void Param::resampleToControlRate()
+{
+	const size_t numFrames = mInternalBuffer.getNumFrames();
+	const size_t controlPeriod = getControlPeriodForBlock();
+	const size_t numControlValues = getNumControlValues();
+	float *controlValues = mControlBuffer.getData();
+
+	for( size_t i = 0; i < numControlValues; i++ )
+		controlValues[i] = mInternalBuffer[min( i * controlPeriod, numFrames - 1 )];
 
-	return samplesWritten != 0;
+	fillFromControlValues();
 }
 
-// ----------------------------------------------------------------------------------------------------
-// MARK: - Protected
-// ----------------------------------------------------------------------------------------------------
+size_t Param::getControlPeriodForBlock() const
+{
+	return mEvalRate == EvalRate::BLOCK ? mInternalBuffer.getNumFrames() : min( mControlPeriod, mInternalBuffer.getNumFrames() );
+}
 
-void Param::resetImpl()
+RampRef Param::scheduleRamp( EventType type, uint64_t frameBegin, uint64_t frameEnd, float valueBegin, float valueEnd, const Options &options )
+{
+	RampRef ramp( new Ramp( frameBegin, frameEnd, valueBegin, valueEnd, getContext()->getSampleRate(), options.getRampType() ) );
+
+	Event event;
+	event.mType = type;
+	event.mFrameBegin = frameBegin;
+	event.mFrameEnd = frameEnd;
+	event.mValueBegin = valueBegin;
+	event.mValueEnd = valueEnd;
+	event.mRampType = options.getRampType();
+	event.mRampFn = options.getRampFn();
+	event.mRamp = ramp.get();
+
+	CI_ASSERT_MSG( ( event.mRampType != RampType::CUSTOM || event.mRampFn ), "RampType::CUSTOM requires a RampFn" );
+
+	// canceled Ramp's that the audio thread hasn't released yet don't count, they are dropped as soon as it sees them.
+	if( countActiveRamps() >= MAX_SCHEDULED_RAMPS ) {
+		CI_LOG_E( "too many scheduled ramps, dropping." );
+		ramp->mIsCanceled = true;
+		ramp->mIsReleased = true;
+		return ramp;
+	}
+
+	mScheduledRamps.push_back( ramp );
+	pushEvent( event );
+
+	return ramp;
+}
+
+void Param::pushEvent( const Event &event )
+{
+	mEventQueue.push( event, getContext()->getMutex(), [this] { processEvents(); } );
+}
+
+// Ramp's are only removed here, on the user thread, once the audio thread has marked them as released.
+void Param::pruneScheduledRamps() const
+{
+	mScheduledRamps.erase( remove_if( mScheduledRamps.begin(), mScheduledRamps.end(),
+							[]( const RampRef &ramp ) { return ramp->mIsReleased.load(); } ), mScheduledRamps.end() );
+}
+
+size_t Param::countActiveRamps() const
 {
-	if( ! mRamps.empty() ) {
-		for( auto &ramp : mRamps )
+	pruneScheduledRamps();
+	return count_if( mScheduledRamps.begin(), mScheduledRamps.end(), []( const RampRef &ramp ) { return ! ramp->mIsCanceled; } );
+}
+
+const Ramp* Param::findLastScheduledRamp() const
+{
+	pruneScheduledRamps();
+
+	for( auto rampIt = mScheduledRamps.rbegin(); rampIt != mScheduledRamps.rend(); ++rampIt ) {
+		if( ! (*rampIt)->mIsCanceled )
+			return rampIt->get();
+	}
+
+	return nullptr;
+}
+
+bool Param::cancelScheduledRamps()
+{
+	bool canceled = false;
+	for( auto &ramp : mScheduledRamps ) {
+		if( ! ramp->mIsCanceled ) {
 			ramp->cancel();
+			canceled = true;
+		}
+	}
+
+	return canceled;
+}
+
+void Param::processEvents()
+{
+	Event event;
+	while( mEventQueue.pop( &event ) ) {
+
+		switch( event.mType ) {
+			case EventType::SET_VALUE:
+				mValue = event.mValueEnd;
+				releaseEvents();
+				break;
+			case EventType::CLEAR:
+				releaseEvents();
+				break;
+			case EventType::APPLY_RAMP:
+				releaseEvents();
+				mEvents.push_back( event );
+				break;
+			case EventType::APPEND_RAMP:
+				if( mEvents.size() < MAX_SCHEDULED_RAMPS )
+					mEvents.push_back( event );
+				else
+					releaseEvent( event, false );
+				break;
+		}
+	}
+}
+
+void Param::renderRamp( const Event &event, float *array, size_t count, float t, float tIncr ) const
+{
+	const pair<float, float> valueRange( event.mValueBegin, event.mValueEnd );
+
+	switch( event.mRampType ) {
+		case RampType::LINEAR:		rampLinear( array, count, t, tIncr, valueRange );	break;
+		case RampType::IN_QUAD:		rampInQuad( array, count, t, tIncr, valueRange );	break;
+		case RampType::OUT_QUAD:	rampOutQuad( array, count, t, tIncr, valueRange );	break;
+		case RampType::S_CURVE:		rampSCurve( array, count, t, tIncr, valueRange );	break;
+		case RampType::EXPONENTIAL:	rampExponential( array, count, t, tIncr, valueRange ); break;
+		case RampType::SET_TARGET:	rampSetTarget( array, count, t, tIncr, valueRange ); break;
+		case RampType::CUSTOM:		event.mRampFn( array, count, t, tIncr, valueRange ); break;
+	}
+}
+
+void Param::releaseEvent( const Event &event, bool complete )
+{
+	if( complete )
+		event.mRamp->mIsComplete = true;
+
+	event.mRamp->mIsReleased = true;
+}
+
+void Param::releaseEvents()
+{
+	for( const auto &event : mEvents )
+		releaseEvent( event, false );
+
+	mEvents.clear();
+}
+
+// Cancels all scheduled Ramp's and tells the audio thread to drop them. Requires mScheduleMutex to be held.
+void Param::resetImpl()
+{
+	disconnectProcessor();
 
-		mRamps.clear();
+	if( cancelScheduledRamps() ) {
+		Event event = {};
+		event.mType = EventType::CLEAR;
+		pushEvent( event );
 	}
+}
+
+void Param::disconnectProcessor()
+{
+	if( mProcessor || mModulationBus ) {
+		lock_guard<mutex> lock( getContext()->getMutex() );
+		mProcessor.reset();
+		mModulationBus.reset();
+	}
+}
+
+// Scales and offsets the shared modulation samples into mInternalBuffer. At control rate only the control points are read from the bus.
+void Param::evalModulation()
+{
+	const float *modulation = mModulationBus->render();
+	const float depth = mModulationDepth;
+	const float offset = mModulationOffset;
+	const size_t numFrames = mInternalBuffer.getNumFrames();
+
+	if( mEvalRate == EvalRate::AUDIO )
+		dsp::mulAdd( modulation, depth, offset, mInternalBuffer.getData(), numFrames );
+	else {
+		const size_t controlPeriod = getControlPeriodForBlock();
+		const size_t numControlValues = getNumControlValues();
+		float *controlValues = mControlBuffer.getData();
+		for( size_t i = 0; i < numControlValues; i++ )
+			controlValues[i] = modulation[min( i * controlPeriod, numFrames - 1 )] * depth + offset;
 
-	mProcessor.reset();
+		fillFromControlValues();
+	}
+
+	mValue = mInternalBuffer[numFrames - 1];
 }
 
 void Param::initInternalBuffer()
 {
-	if( mInternalBuffer.isEmpty() )
-		mInternalBuffer.setNumFrames( getContext()->getFramesPerBlock() );
+	if( mInternalBuffer.isEmpty() ) {
+		const size_t framesPerBlock = getContext()->getFramesPerBlock();
+		mInternalBuffer.setNumFrames( framesPerBlock );
+		// enough room for the smallest control period, plus the point at the end of the block used for interpolation
+		mControlBuffer.setNumFrames( framesPerBlock + 1 );
+	}
 }
 
 ContextRef Param::getContext() const
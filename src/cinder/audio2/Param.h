@@ -24,10 +24,11 @@
 #pragma once
 
 #include "cinder/audio2/Buffer.h"
+#include "cinder/audio2/dsp/RingBuffer.h"
 
-#include <list>
+#include <vector>
 #include <atomic>
-#include <functional>
+#include <mutex>
 
 namespace cinder { namespace audio2 {
 
@@ -36,8 +37,20 @@ typedef std::shared_ptr<class Node>			NodeRef;
 
 //! A Reference to Ramp's returned by the ramping methods. \see applyRamp() \see appendRamp()
 typedef std::shared_ptr<class Ramp>			RampRef;
-//! note: unless we want to add _VARIADIC_MAX=6 in preprocessor definitions to all projects, number of args here has to be 5 or less for vc11 support
-typedef std::function<void ( float *, size_t, float, float, const std::pair<float, float>& )>	RampFn;
+typedef std::shared_ptr<class ModulationBus>	ModulationBusRef;
+//! Signature for custom ramping functions: fills \a count samples of \a array starting at normalized time \a t, which advances by \a tIncr per sample.
+typedef void (*RampFn)( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
+
+//! Built-in ramp shapes, evaluated without any indirect function call. \see Param::Options::rampType()
+enum class RampType {
+	LINEAR,		//! linear interpolation from begin to end value.
+	IN_QUAD,	//! quadradic (t^2) ease-in.
+	OUT_QUAD,	//! quadradic (t^2) ease-out.
+	S_CURVE,	//! cubic (smoothstep) ease-in and ease-out.
+	EXPONENTIAL,	//! exponential curve, perceptually linear for gain and frequency. Falls back to LINEAR if the values cross or touch zero.
+	SET_TARGET,	//! one-pole (RC) approach to the end value, normalized so that it lands on the end value.
+	CUSTOM		//! uses the RampFn set with Param::Options::rampFn().
+};
 
 //! Array-based linear ramping function.
 void rampLinear( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
@@ -45,50 +58,99 @@ void rampLinear( float *array, size_t count, float t, float tIncr, const std::pa
 void rampInQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
 //! Array-based quadradic (t^2) ease-out ramping function.
 void rampOutQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
-
+//! Array-based cubic (smoothstep) ease-in and ease-out ramping function.
+void rampSCurve( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
+//! Array-based exponential ramping function. \note Falls back to rampLinear() if the values cross or touch zero.
+void rampExponential( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
+//! Array-based one-pole (set target) ramping function, normalized so the curve ends at the end value.
+void rampSetTarget( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
+
+//! Handle to a scheduled Ramp, which can be used to query its progress or cancel it from a non-audio thread.
 class Ramp {
   public:
-	float getTimeBegin()		const	{ return mTimeBegin; }
-	float getTimeEnd()			const	{ return mTimeEnd; }
-	float getDuration()			const	{ return mDuration; }
-	float getValueBegin()		const	{ return mValueBegin; }
-	float getValueEnd()			const	{ return mValueEnd; }
-	const RampFn& getRampFn()	const	{ return mRampFn; }
+	float		getTimeBegin()		const	{ return mTimeBegin; }
+	float		getTimeEnd()		const	{ return mTimeEnd; }
+	float		getDuration()		const	{ return mTimeEnd - mTimeBegin; }
+	uint64_t	getFrameBegin()		const	{ return mFrameBegin; }
+	uint64_t	getFrameEnd()		const	{ return mFrameEnd; }
+	float		getValueBegin()		const	{ return mValueBegin; }
+	float		getValueEnd()		const	{ return mValueEnd; }
+	RampType	getRampType()		const	{ return mRampType; }
 
 	void cancel()				{ mIsCanceled = true; }
 	bool isComplete() const		{ return mIsComplete; }
 
   private:
-	Ramp( float timeBegin, float timeEnd, float valueBegin, float valueEnd, const RampFn &rampFn );
+	Ramp( uint64_t frameBegin, uint64_t frameEnd, float valueBegin, float valueEnd, size_t sampleRate, RampType rampType );
 
-	float				mTimeBegin, mTimeEnd, mDuration;
+	uint64_t			mFrameBegin, mFrameEnd;
+	float				mTimeBegin, mTimeEnd;
 	float				mValueBegin, mValueEnd;
+	RampType			mRampType;
 	std::atomic<bool>	mIsComplete, mIsCanceled;
-	RampFn	mRampFn;
+	std::atomic<bool>	mIsReleased; // set by the audio thread once it no longer references this Ramp
 
 	friend class Param;
 };
 
+//! \brief Renders a processing Node once per block into a buffer that is shared by any number of Param's. \see Param::setModulation()
+//!
+//! Unlike Param::setProcessor(), where each Param pulls and copies its own processor, the processing Node is pulled at most once per
+//! processing block no matter how many Param's read from the bus. Each Param applies its own depth and offset to the shared samples.
+class ModulationBus {
+  public:
+	//! Creates a ModulationBus that renders \a processor. \note Forces \a processor to be mono.
+	static ModulationBusRef create( const NodeRef &processor )	{ return ModulationBusRef( new ModulationBus( processor ) ); }
+
+	//! Returns the processing Node rendered by this bus.
+	const NodeRef&	getProcessor() const	{ return mProcessor; }
+	//! Renders the processing Node if it hasn't been for the current processing block, and returns the rendered samples. \note Only safe to call on the audio thread.
+	const float*	render();
+
+  private:
+	ModulationBus( const NodeRef &processor );
+
+	NodeRef			mProcessor;
+	BufferDynamic	mBuffer;
+	uint64_t		mLastRenderedFrame;
+	bool			mIsRendered;
+};
+
+//! \brief Controllable parameter of a Node, which can be set to a fixed value, automated with Ramp's or driven by a processing Node.
+//!
+//! Ramp's are scheduled from the user thread by pushing events into a lock-free queue, which the audio thread drains into a fixed-capacity
+//! timeline at the beginning of each eval(). Neither side allocates or blocks the other while scheduling or evaluating Ramp's.
 class Param {
   public:
+	//! Specifies how often a varying Param computes its value. \see setEvalRate()
+	enum class EvalRate {
+		AUDIO,		//! a value is computed for every sample (default).
+		CONTROL,	//! a value is computed every getControlPeriod() samples.
+		BLOCK		//! a value is computed once per processing block.
+	};
 
 	//! Optional parameters when applying or appending ramps. \see applyRamp() \see appendRamp()
 	struct Options {
-		Options() : mDelay( 0 ), mRampFn( rampLinear ) {}
+		Options() : mDelay( 0 ), mRampType( RampType::LINEAR ), mRampFn( nullptr ) {}
 
 		//! Specifies a delay of \a delay in seconds.
 		Options& delay( float delay )				{ mDelay = delay; return *this; }
-		//! Specifies the ramping function used during evaluation.
-		Options& rampFn( const RampFn &rampFn )		{ mRampFn = rampFn; return *this; }
+		//! Specifies the built-in ramp shape used during evaluation. Default is RampType::LINEAR.
+		Options& rampType( RampType type )			{ mRampType = type; return *this; }
+		//! Specifies a custom ramping function used during evaluation. Built-in shapes (see rampType()) are cheaper to evaluate.
+		Options& rampFn( RampFn rampFn )			{ mRampFn = rampFn; mRampType = RampType::CUSTOM; return *this; }
 
 		//! Returns the delay specified in seconds.
-		float getDelay() const				{ return mDelay; }
-		//! Returns the ramping function that will be used during evaluation.
-		const RampFn&	getRampFn() const	{ return mRampFn; }
+		float		getDelay() const		{ return mDelay; }
+		//! Returns the ramp shape that will be used during evaluation.
+		RampType	getRampType() const		{ return mRampType; }
+		//! Returns the custom ramping function, or \c nullptr if a built-in shape is used.
+		RampFn		getRampFn() const		{ return mRampFn; }
 
 	  private:
-		float mDelay;
-		RampFn	mRampFn;
+		float		mDelay;
+		RampType	mRampType;
+		RampFn		mRampFn;
 	};
 
 	//! Constructs a Param with a pointer (weak reference) to the owning parent Node and an optional \a initialValue (default = 0).
@@ -113,6 +175,19 @@ class Param {
 	//! \note Forces \a node to be mono.
 	void setProcessor( const NodeRef &node );
 
+	//! Sets this Param's input to the samples rendered by \a bus, as \code offset + depth * modulation \endcode. Any existing Ramp's or processing Node are discarded.
+	void	setModulation( const ModulationBusRef &bus, float depth = 1, float offset = 0 );
+	//! Returns the ModulationBus this Param reads from, or an empty reference if there is none.
+	const ModulationBusRef& getModulationBus() const	{ return mModulationBus; }
+	//! Sets the amount the ModulationBus's samples are scaled by. Safe to call from any thread.
+	void	setModulationDepth( float depth )			{ mModulationDepth = depth; }
+	//! Returns the amount the ModulationBus's samples are scaled by.
+	float	getModulationDepth() const					{ return mModulationDepth; }
+	//! Sets the value added to the scaled ModulationBus's samples. Safe to call from any thread.
+	void	setModulationOffset( float offset )			{ mModulationOffset = offset; }
+	//! Returns the value added to the scaled ModulationBus's samples.
+	float	getModulationOffset() const					{ return mModulationOffset; }
+
 	//! Resets Param, blowing away any Ramp's or processing Node. \note Must be called from a non-audio thread.
 	void reset();
 	//! Returns the number of Ramp's that are currently scheduled.
@@ -122,28 +197,94 @@ class Param {
 	//! \return true if the Param is varying this block (there are Ramp's or a processing Node) and getValueArray() should be used, or false if the Param's value is constant for this block (use getValue()).
 	//! \note Safe to call on the audio thread.
 	bool	eval();
-	//! Evaluates the Param from \a timeBegin for \a arrayLength samples at \a sampleRate.
+	//! Evaluates the Param from \a frameBegin for \a arrayLength samples, filling \a array if the Param is varying.
 	//! \return true if the Param is varying this block (there are Ramp's or a processing Node) and getValueArray() should be used, or false if the Param's value is constant for this block (use getValue()).
 	//! \note Safe to call on the audio thread.
-	bool	eval( float timeBegin, float *array, size_t arrayLength, size_t sampleRate );
+	bool	eval( uint64_t frameBegin, float *array, size_t arrayLength );
+
+	//! Sets how often the Param computes its value when varying. At EvalRate::CONTROL or EvalRate::BLOCK the values in between are linearly
+	//! interpolated if \a interpolate is true, otherwise the last computed value is held. getValueArray() is always filled at audio rate.
+	//! \note A processing Node still renders at audio rate, its output is decimated to control rate.
+	void		setEvalRate( EvalRate rate, bool interpolate = true );
+	//! Returns the rate at which the Param computes its value.
+	EvalRate	getEvalRate() const			{ return mEvalRate; }
+	//! Returns whether values in between control rate evaluations are interpolated (true) or held (false).
+	bool		isInterpolating() const		{ return mInterpolate; }
+	//! Sets the number of samples between values computed at EvalRate::CONTROL. Default is 32.
+	void		setControlPeriod( size_t frames );
+	//! Returns the number of samples between values computed at EvalRate::CONTROL.
+	size_t		getControlPeriod() const	{ return mControlPeriod; }
+
+	//! Returns true if the Param has Ramp's scheduled or a processing Node, without evaluating it. \note Only safe to call on the audio thread.
+	bool	isRamping() const;
+	//! Returns the result of the last call to eval(), which is whether getValueArray() was filled for the current block.
+	bool	isVarying() const	{ return mIsVarying; }
+	//! Returns the values computed during the last eval() at EvalRate::CONTROL or EvalRate::BLOCK, one per control period plus one at the end of the block.
+	//! Nodes that derive expensive per-sample state (ex. filter coefficients) from the Param can use these instead of getValueArray().
+	const float*	getControlValueArray() const;
+	//! Returns the number of values in getControlValueArray().
+	size_t			getNumControlValues() const;
 
 	//! Returns the total duration of any scheduled Param's, including delay, or 0 if none are scheduled.
 	float					findDuration() const;
 	//! Returns the end time and value of the latest scheduled Param, or [0, getValue()] if none are scheduled.
 	std::pair<float, float> findEndTimeAndValue() const;
 
+	//! The maximum number of Ramp's that can be scheduled at once, additional Ramp's are dropped.
+	static const size_t MAX_SCHEDULED_RAMPS = 32;
+
   protected:
+	//! Commands sent from the user thread to the audio thread through mEventQueue.
+	enum class EventType { APPLY_RAMP, APPEND_RAMP, SET_VALUE, CLEAR };
+
+	//! POD copy of a scheduled Ramp, which is all the audio thread needs for evaluation.
+	struct Event {
+		EventType	mType;
+		uint64_t	mFrameBegin, mFrameEnd;
+		float		mValueBegin, mValueEnd;
+		RampType	mRampType;
+		RampFn		mRampFn;
+		Ramp*		mRamp; // kept alive by mScheduledRamps until released
+	};
 
 	// non-locking protected methods
+	RampRef		scheduleRamp( EventType type, uint64_t frameBegin, uint64_t frameEnd, float valueBegin, float valueEnd, const Options &options );
+	void		pushEvent( const Event &event );
+	void		pruneScheduledRamps() const;
+	size_t		countActiveRamps() const;
+	const Ramp*	findLastScheduledRamp() const;
+	bool		cancelScheduledRamps();
+	void		processEvents();
+	bool		evalTimeline( uint64_t frameBegin, size_t frameStride, float *array, size_t count, uint64_t frameEnd );
+	void		fillFromControlValues();
+	void		resampleToControlRate();
+	size_t		getControlPeriodForBlock() const;
+	void		renderRamp( const Event &event, float *array, size_t count, float t, float tIncr ) const;
+	void		releaseEvent( const Event &event, bool complete );
+	void		releaseEvents();
+	void		disconnectProcessor();
+	void		evalModulation();
 	void		initInternalBuffer();
 	void		resetImpl();
 	ContextRef	getContext() const;
 
-	std::list<RampRef>	mRamps;
-	std::atomic<float>	mValue;
-	Node*				mParentNode;
-	NodeRef				mProcessor;
-	BufferDynamic		mInternalBuffer;
+	// audio thread
+	std::vector<Event>				mEvents;			// fixed capacity timeline, sorted by begin frame
+	// user thread
+	mutable std::vector<RampRef>	mScheduledRamps;	// keeps Ramp's alive while the audio thread references them
+	mutable std::mutex				mScheduleMutex;		// serializes producers of mEventQueue, never taken by the audio thread
+
+	dsp::CommandQueueT<Event>	mEventQueue;
+	std::atomic<float>		mValue;
+	Node*					mParentNode;
+	NodeRef					mProcessor;
+	ModulationBusRef		mModulationBus;
+	std::atomic<float>		mModulationDepth, mModulationOffset;
+	BufferDynamic			mInternalBuffer;
+	BufferDynamic			mControlBuffer;		// values computed at control rate, expanded into mInternalBuffer
+	EvalRate				mEvalRate;
+	size_t					mControlPeriod;
+	bool					mInterpolate, mIsVarying;
 };
 
 } } // namespace cinder::audio2
\ No newline at end of file
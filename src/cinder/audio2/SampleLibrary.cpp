@@ -0,0 +1,515 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio2/SampleLibrary.h"
+#include "cinder/audio2/Debug.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <cmath>
+
+using namespace std;
+
+namespace cinder { namespace audio2 {
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Disk cache
+// ----------------------------------------------------------------------------------------------------
+
+namespace {
+
+const char		kCacheMagic[4] = { 'C', 'A', 'P', 'C' };
+const uint32_t	kCacheVersion = 1;
+
+// Written at the start of each cache file, followed by the samples in the same planar layout as Buffer.
+struct CacheHeader {
+	char		mMagic[4];
+	uint32_t	mVersion;
+	uint32_t	mFormat;
+	uint32_t	mNumChannels;
+	uint64_t	mNumFrames;
+	uint64_t	mSourceHash;
+	int64_t		mSourceModifiedTime;
+	float		mSampleScale;	// INT16 samples are stored divided by this, so that peaks above 1 aren't clipped
+	uint32_t	mReserved;
+};
+
+// Cache file names begin with the hash of the source's path, followed by the hash of its contents and its modification time.
+const size_t kCacheNamePathLength = 17;		// 16 hex digits and '_'
+const size_t kCacheNameVersionOffset = 34;	// the modification time begins after the contents hash and its '_'
+
+// 64-bit FNV-1a, continuing from hash
+uint64_t hashBytes( const char *data, size_t size, uint64_t hash = 14695981039346656037ULL )
+{
+	for( size_t i = 0; i < size; i++ ) {
+		hash ^= (uint8_t)data[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+bool hashFile( const fs::path &path, uint64_t *hash )
+{
+	ifstream stream( path.string().c_str(), ios::binary );
+	if( ! stream )
+		return false;
+
+	uint64_t result = hashBytes( nullptr, 0 );
+	vector<char> chunk( 65536 );
+	while( stream ) {
+		stream.read( chunk.data(), chunk.size() );
+		result = hashBytes( chunk.data(), (size_t)stream.gcount(), result );
+	}
+
+	*hash = result;
+	return stream.eof();
+}
+
+// Returns the cache file path for sourcePath, filling in the fields of header that identify the source. Returns an empty path if the source can't be read.
+// The whole source file is read to hash it, on every load and whether or not the cache file exists, so a cached load still costs a read of the encoded file.
+fs::path makeCachePath( const fs::path &directory, const fs::path &sourcePath, size_t sampleRate, size_t numChannels, SampleLibrary::CacheFormat format, CacheHeader *header )
+{
+	boost::system::error_code error;
+	time_t modifiedTime = fs::last_write_time( sourcePath, error );
+	uint64_t hash;
+	if( error || ! hashFile( sourcePath, &hash ) )
+		return fs::path();
+
+	const string sourcePathStr = sourcePath.string();
+	uint64_t pathHash = hashBytes( sourcePathStr.data(), sourcePathStr.size() );
+
+	memcpy( header->mMagic, kCacheMagic, sizeof( kCacheMagic ) );
+	header->mVersion = kCacheVersion;
+	header->mFormat = (uint32_t)format;
+	header->mNumChannels = 0;
+	header->mNumFrames = 0;
+	header->mSourceHash = hash;
+	header->mSourceModifiedTime = (int64_t)modifiedTime;
+	header->mSampleScale = 1;
+	header->mReserved = 0;
+
+	ostringstream name;
+	name << hex << setfill( '0' ) << setw( 16 ) << pathHash << "_" << setw( 16 ) << hash << dec << "_" << (int64_t)modifiedTime << "_" << sampleRate << "_" << numChannels;
+	name << ( format == SampleLibrary::CacheFormat::INT16 ? "_s16" : "_f32" ) << ".pcm";
+
+	return directory / name.str();
+}
+
+// Returns an empty BufferRef if there is no valid cache file at path for the source described by expected.
+BufferRef readCacheFile( const fs::path &path, const CacheHeader &expected )
+{
+	ifstream stream( path.string().c_str(), ios::binary );
+	if( ! stream )
+		return BufferRef();
+
+	CacheHeader header;
+	if( ! stream.read( (char *)&header, sizeof( header ) ) )
+		return BufferRef();
+
+	if( memcmp( header.mMagic, expected.mMagic, sizeof( header.mMagic ) ) || header.mVersion != expected.mVersion || header.mFormat != expected.mFormat
+			|| header.mSourceHash != expected.mSourceHash || header.mSourceModifiedTime != expected.mSourceModifiedTime || ! header.mNumChannels ) {
+		CI_LOG_W( "ignoring mismatched cache file: " << path );
+		return BufferRef();
+	}
+
+	auto result = make_shared<Buffer>( (size_t)header.mNumFrames, (size_t)header.mNumChannels );
+	if( header.mFormat == (uint32_t)SampleLibrary::CacheFormat::INT16 ) {
+		vector<int16_t> samples( result->getSize() );
+		stream.read( (char *)samples.data(), samples.size() * sizeof( int16_t ) );
+
+		float *data = result->getData();
+		const float scale = header.mSampleScale / 32767.0f;
+		for( size_t i = 0; i < samples.size(); i++ )
+			data[i] = (float)samples[i] * scale;
+	}
+	else
+		stream.read( (char *)result->getData(), result->getSize() * sizeof( float ) );
+
+	if( ! stream ) {
+		CI_LOG_W( "ignoring truncated cache file: " << path );
+		return BufferRef();
+	}
+
+	return result;
+}
+
+// Once a cache file has been written for the current contents of a source, those written for its earlier contents (in any format) can never
+// be read again. They are removed so that the directory doesn't grow each time a source changes. Files of other sources are left alone.
+void removeSupersededCacheFiles( const fs::path &path )
+{
+	const string name = path.filename().string();
+	const string pathPrefix = name.substr( 0, kCacheNamePathLength );
+	const string versionPrefix = name.substr( 0, name.find( '_', kCacheNameVersionOffset ) + 1 );
+
+	vector<fs::path> superseded;
+	boost::system::error_code error;
+	for( fs::directory_iterator it( path.parent_path(), error ), end; ! error && it != end; it.increment( error ) ) {
+		const fs::path &otherPath = it->path();
+		const string otherName = otherPath.filename().string();
+		if( otherPath.extension() == ".pcm" && otherName.compare( 0, pathPrefix.size(), pathPrefix ) == 0 && otherName.compare( 0, versionPrefix.size(), versionPrefix ) != 0 )
+			superseded.push_back( otherPath );
+	}
+
+	for( const auto &supersededPath : superseded ) {
+		if( fs::remove( supersededPath, error ) )
+			CI_LOG_V( "removed superseded cache file: " << supersededPath );
+	}
+}
+
+void writeCacheFile( const fs::path &path, const Buffer &buffer, CacheHeader header )
+{
+	header.mNumChannels = (uint32_t)buffer.getNumChannels();
+	header.mNumFrames = buffer.getNumFrames();
+
+	if( header.mFormat == (uint32_t)SampleLibrary::CacheFormat::INT16 ) {
+		const float *data = buffer.getData();
+		for( size_t i = 0; i < buffer.getSize(); i++ )
+			header.mSampleScale = max( header.mSampleScale, fabs( data[i] ) );
+	}
+
+	boost::system::error_code error;
+	fs::create_directories( path.parent_path(), error );
+
+	// written under a temporary name and then renamed, so that a partially written file is never read
+	ostringstream tempName;
+	tempName << path.filename().string() << "." << this_thread::get_id() << ".tmp";
+	fs::path tempPath = path.parent_path() / tempName.str();
+
+	bool succeeded;
+	{
+		ofstream stream( tempPath.string().c_str(), ios::binary );
+		stream.write( (const char *)&header, sizeof( header ) );
+
+		if( header.mFormat == (uint32_t)SampleLibrary::CacheFormat::INT16 ) {
+			const float *data = buffer.getData();
+			const float scale = 32767.0f / header.mSampleScale;
+			vector<int16_t> samples( buffer.getSize() );
+			for( size_t i = 0; i < samples.size(); i++ )
+				samples[i] = (int16_t)lrintf( data[i] * scale );
+
+			stream.write( (const char *)samples.data(), samples.size() * sizeof( int16_t ) );
+		}
+		else
+			stream.write( (const char *)buffer.getData(), buffer.getSize() * sizeof( float ) );
+
+		succeeded = !! stream;
+	}
+
+	if( succeeded )
+		fs::rename( tempPath, path, error );
+
+	if( ! succeeded || error ) {
+		CI_LOG_W( "failed to write cache file: " << path );
+		fs::remove( tempPath, error );
+	}
+	else
+		removeSupersededCacheFiles( path );
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SampleLibrary
+// ----------------------------------------------------------------------------------------------------
+
+SampleLibrary::SampleLibrary( const Format &format )
+	: mNumBytes( 0 ), mMemoryBudget( format.getMemoryBudget() ), mNextLoadId( 0 ), mCacheDirectory( format.getCacheDirectory() ),
+	mCacheFormat( format.getCacheFormat() ), mQuit( false )
+{
+	for( size_t i = 0; i < max<size_t>( 1, format.getNumThreads() ); i++ )
+		mThreads.emplace_back( &SampleLibrary::threadLoop, this );
+}
+
+SampleLibrary::~SampleLibrary()
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mQuit = true;
+		mTasks.clear();
+	}
+
+	mTaskCondition.notify_all();
+	for( auto &t : mThreads )
+		t.join();
+}
+
+BufferRef SampleLibrary::load( const DataSourceRef &dataSource, size_t sampleRate, size_t numChannels )
+{
+	Key key = makeKey( dataSource, sampleRate, numChannels );
+
+	PromiseRef promise;
+	uint64_t loadId;
+	auto future = findOrBeginLoad( key, dataSource, &promise, &loadId );
+	if( promise )
+		performLoad( key, dataSource, promise, loadId );
+
+	return future.get();
+}
+
+void SampleLibrary::preload( const vector<DataSourceRef> &dataSources, const ProgressFn &progressFn, size_t sampleRate, size_t numChannels )
+{
+	if( dataSources.empty() )
+		return;
+
+	auto batch = make_shared<Batch>();
+	batch->mProgressFn = progressFn;
+	batch->mNumTotal = dataSources.size();
+	batch->mNumFinished = 0;
+
+	{
+		lock_guard<mutex> lock( mMutex );
+		for( const auto &dataSource : dataSources ) {
+			Task task = { makeKey( dataSource, sampleRate, numChannels ), dataSource, batch };
+			mTasks.push_back( task );
+		}
+	}
+
+	mTaskCondition.notify_all();
+}
+
+BufferRef SampleLibrary::get( const DataSourceRef &dataSource, size_t sampleRate, size_t numChannels )
+{
+	Key key = makeKey( dataSource, sampleRate, numChannels );
+
+	lock_guard<mutex> lock( mMutex );
+
+	auto entryIt = mEntries.find( key );
+	if( entryIt == mEntries.end() || ! entryIt->second.mLoaded )
+		return BufferRef();
+
+	mLru.splice( mLru.begin(), mLru, entryIt->second.mLruPos );
+	return entryIt->second.mFuture.get();
+}
+
+void SampleLibrary::remove( const DataSourceRef &dataSource, size_t sampleRate, size_t numChannels )
+{
+	Key key = makeKey( dataSource, sampleRate, numChannels );
+
+	lock_guard<mutex> lock( mMutex );
+
+	auto entryIt = mEntries.find( key );
+	if( entryIt != mEntries.end() )
+		removeEntry( entryIt );
+}
+
+void SampleLibrary::clear()
+{
+	lock_guard<mutex> lock( mMutex );
+
+	while( ! mEntries.empty() )
+		removeEntry( mEntries.begin() );
+}
+
+size_t SampleLibrary::getNumBytes() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mNumBytes;
+}
+
+void SampleLibrary::setMemoryBudget( size_t bytes )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	mMemoryBudget = bytes;
+	evictBuffers();
+}
+
+size_t SampleLibrary::getMemoryBudget() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mMemoryBudget;
+}
+
+SampleLibrary::Key SampleLibrary::makeKey( const DataSourceRef &dataSource, size_t sampleRate, size_t numChannels ) const
+{
+	string path;
+	if( dataSource->isFilePath() ) {
+		// so that different spellings of the same file share one entry
+		boost::system::error_code error;
+		fs::path canonicalPath = fs::canonical( dataSource->getFilePath(), error );
+		path = error ? dataSource->getFilePath().string() : canonicalPath.string();
+	}
+	else {
+		// a file path hint isn't unique, so other sources are keyed by address. The entry holds on to the DataSource so the address isn't reused while it exists.
+		ostringstream str;
+		str << dataSource.get();
+		path = str.str();
+	}
+
+	return make_tuple( path, sampleRate, numChannels );
+}
+
+// Returns the future of the entry for key. If there wasn't one, an entry is added and promise and loadId are set, in which case the caller must call performLoad().
+shared_future<BufferRef> SampleLibrary::findOrBeginLoad( const Key &key, const DataSourceRef &dataSource, PromiseRef *promise, uint64_t *loadId )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	auto entryIt = mEntries.find( key );
+	if( entryIt != mEntries.end() ) {
+		if( entryIt->second.mLoaded )
+			mLru.splice( mLru.begin(), mLru, entryIt->second.mLruPos );
+
+		return entryIt->second.mFuture;
+	}
+
+	*promise = make_shared<std::promise<BufferRef> >();
+	*loadId = mNextLoadId++;
+
+	Entry &entry = mEntries[key];
+	entry.mFuture = (*promise)->get_future().share();
+	entry.mLoadId = *loadId;
+	entry.mLoaded = false;
+	entry.mNumBytes = 0;
+	if( ! dataSource->isFilePath() )
+		entry.mDataSource = dataSource;
+
+	return entry.mFuture;
+}
+
+void SampleLibrary::performLoad( const Key &key, const DataSourceRef &dataSource, const PromiseRef &promise, uint64_t loadId )
+{
+	BufferRef buffer;
+	try {
+		buffer = decode( key, dataSource );
+	}
+	catch( ... ) {
+		// the entry is dropped so that a later load can try again, waiters receive the exception.
+		{
+			lock_guard<mutex> lock( mMutex );
+			auto entryIt = mEntries.find( key );
+			if( entryIt != mEntries.end() && entryIt->second.mLoadId == loadId )
+				mEntries.erase( entryIt );
+		}
+
+		promise->set_exception( current_exception() );
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		// the entry may have been removed or replaced while loading, in which case the buffer isn't kept
+		auto entryIt = mEntries.find( key );
+		if( entryIt != mEntries.end() && entryIt->second.mLoadId == loadId ) {
+			Entry &entry = entryIt->second;
+			entry.mLoaded = true;
+			entry.mNumBytes = buffer->getSize() * sizeof( float );
+			mLru.push_front( key );
+			entry.mLruPos = mLru.begin();
+			mNumBytes += entry.mNumBytes;
+
+			evictBuffers();
+		}
+	}
+
+	promise->set_value( buffer );
+}
+
+// Reads the samples from the cache directory if they are there, otherwise decodes them and writes them there.
+BufferRef SampleLibrary::decode( const Key &key, const DataSourceRef &dataSource )
+{
+	size_t sampleRate = std::get<1>( key );
+	size_t numChannels = std::get<2>( key );
+
+	fs::path cachePath;
+	CacheHeader cacheHeader;
+	if( ! mCacheDirectory.empty() && dataSource->isFilePath() ) {
+		// the key holds the canonical path, so that all spellings of it share the same cache files
+		cachePath = makeCachePath( mCacheDirectory, std::get<0>( key ), sampleRate, numChannels, mCacheFormat, &cacheHeader );
+		if( ! cachePath.empty() ) {
+			BufferRef cached = readCacheFile( cachePath, cacheHeader );
+			if( cached )
+				return cached;
+		}
+	}
+
+	auto sourceFile = SourceFile::create( dataSource );
+	if( sampleRate || numChannels )
+		sourceFile->setOutputFormat( sampleRate ? sampleRate : sourceFile->getSampleRate(), numChannels );
+
+	BufferRef result = sourceFile->loadBuffer();
+
+	if( ! cachePath.empty() )
+		writeCacheFile( cachePath, *result, cacheHeader );
+
+	return result;
+}
+
+// Expects mMutex to be held.
+void SampleLibrary::removeEntry( map<Key, Entry>::iterator entryIt )
+{
+	if( entryIt->second.mLoaded ) {
+		mNumBytes -= entryIt->second.mNumBytes;
+		mLru.erase( entryIt->second.mLruPos );
+	}
+
+	mEntries.erase( entryIt );
+}
+
+// Expects mMutex to be held. Entries still loading aren't in mLru, so they are never evicted.
+void SampleLibrary::evictBuffers()
+{
+	while( mNumBytes > mMemoryBudget && ! mLru.empty() )
+		removeEntry( mEntries.find( mLru.back() ) );
+}
+
+void SampleLibrary::threadLoop()
+{
+	while( true ) {
+		Task task;
+		{
+			unique_lock<mutex> lock( mMutex );
+			mTaskCondition.wait( lock, [this] { return mQuit || ! mTasks.empty(); } );
+			if( mQuit )
+				return;
+
+			task = mTasks.front();
+			mTasks.pop_front();
+		}
+
+		PromiseRef promise;
+		uint64_t loadId;
+		auto future = findOrBeginLoad( task.mKey, task.mDataSource, &promise, &loadId );
+		if( promise )
+			performLoad( task.mKey, task.mDataSource, promise, loadId );
+
+		// an entry only exists once its load has started, so this never waits on a load that is still queued.
+		try {
+			future.get();
+		}
+		catch( std::exception &exc ) {
+			CI_LOG_E( "failed to load '" << std::get<0>( task.mKey ) << "': " << exc.what() );
+		}
+		catch( ... ) {
+			CI_LOG_E( "failed to load '" << std::get<0>( task.mKey ) << "'" );
+		}
+
+		size_t numFinished = ++task.mBatch->mNumFinished;
+		if( task.mBatch->mProgressFn )
+			task.mBatch->mProgressFn( numFinished, task.mBatch->mNumTotal );
+	}
+}
+
+} } // namespace cinder::audio2
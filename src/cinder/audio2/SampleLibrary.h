@@ -0,0 +1,167 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio2/Source.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <cstdint>
+
+namespace cinder { namespace audio2 {
+
+typedef std::shared_ptr<class SampleLibrary>	SampleLibraryRef;
+
+//! \brief Loads and keeps decoded Buffer's, so that each file is decoded once per output format.
+//!
+//! Files are identified by their canonical path together with the requested samplerate and channel count. Other DataSource's (resources,
+//! urls) are identified by the DataSource object itself, which the library holds on to while its Buffer is kept. preload() decodes batches on the library's own threads, keeping that work off the main thread,
+//! and a file that is already being loaded is waited on rather than loaded again. When the loaded Buffer's exceed the memory budget,
+//! the least recently used are dropped from the library. Buffer's that are still referenced elsewhere stay alive until released.
+//!
+//! If a cache directory is set, each file's decoded and converted samples are also written there, named after hashes of the file's
+//! path and contents, its modification time and the output format. Later loads of an unchanged file, including ones in later runs, read the
+//! samples straight from that file and skip decoding and samplerate conversion, though the file is still read in full to hash its contents.
+//! When a changed file is cached again, the cache files written for its earlier contents are removed.
+class SampleLibrary : public boost::noncopyable {
+  public:
+	//! Called each time a file from a preload() batch finishes loading (or fails to), with the number finished so far and the batch size.
+	typedef std::function<void( size_t numFinished, size_t numTotal )>	ProgressFn;
+
+	//! The sample format of files written to the cache directory.
+	enum class CacheFormat {
+		//! Samples are stored exactly.
+		FLOAT32,
+		//! Samples are quantized to 16 bits, halving the size of the cache.
+		INT16
+	};
+
+	struct Format {
+		Format() : mNumThreads( 2 ), mMemoryBudget( 256 * 1024 * 1024 ), mCacheFormat( CacheFormat::FLOAT32 ) {}
+
+		//! Sets the number of threads used by preload() (default = 2).
+		Format&		numThreads( size_t numThreads )		{ mNumThreads = numThreads; return *this; }
+		//! Sets the number of bytes that loaded Buffer's may use before the least recently used are evicted (default = 256 MB).
+		Format&		memoryBudget( size_t bytes )		{ mMemoryBudget = bytes; return *this; }
+		//! Sets the directory where loaded samples are cached across runs (default = none, nothing is cached on disk). It is created if needed.
+		Format&		cacheDirectory( const fs::path &directory )	{ mCacheDirectory = directory; return *this; }
+		//! Sets the sample format of cached files (default = CacheFormat::FLOAT32).
+		Format&		cacheFormat( CacheFormat format )	{ mCacheFormat = format; return *this; }
+
+		size_t		getNumThreads() const				{ return mNumThreads; }
+		size_t		getMemoryBudget() const				{ return mMemoryBudget; }
+		const fs::path&	getCacheDirectory() const		{ return mCacheDirectory; }
+		CacheFormat	getCacheFormat() const				{ return mCacheFormat; }
+
+	  protected:
+		size_t		mNumThreads, mMemoryBudget;
+		fs::path	mCacheDirectory;
+		CacheFormat	mCacheFormat;
+	};
+
+	SampleLibrary( const Format &format = Format() );
+	//! Stops the library's threads, after waiting for any loads in progress. Queued loads that haven't started are dropped.
+	~SampleLibrary();
+
+	//! Returns the Buffer for \a dataSource, decoding it on the calling thread unless it is already loaded or being loaded by another thread, in which case that load is waited for.
+	//! \a sampleRate and \a numChannels set the output format, where 0 uses the file's own. Throws if the file can't be loaded.
+	BufferRef load( const DataSourceRef &dataSource, size_t sampleRate = 0, size_t numChannels = 0 );
+	//! Queues \a dataSources to be loaded on the library's threads and returns immediately. If set, \a progressFn is called from one of those threads as each file finishes. Failures are logged.
+	void preload( const std::vector<DataSourceRef> &dataSources, const ProgressFn &progressFn = ProgressFn(), size_t sampleRate = 0, size_t numChannels = 0 );
+	//! Returns the Buffer for \a dataSource if it is loaded, otherwise an empty BufferRef. Never waits for a load.
+	BufferRef get( const DataSourceRef &dataSource, size_t sampleRate = 0, size_t numChannels = 0 );
+	//! Returns whether the Buffer for \a dataSource is loaded.
+	bool isLoaded( const DataSourceRef &dataSource, size_t sampleRate = 0, size_t numChannels = 0 )	{ return !! get( dataSource, sampleRate, numChannels ); }
+	//! Removes the Buffer for \a dataSource from the library. A load in progress still completes, but its Buffer isn't kept.
+	void remove( const DataSourceRef &dataSource, size_t sampleRate = 0, size_t numChannels = 0 );
+	//! Removes all Buffer's from the library.
+	void clear();
+
+	//! Returns the number of bytes used by loaded Buffer's.
+	size_t	getNumBytes() const;
+	//! Sets the number of bytes that loaded Buffer's may use, evicting the least recently used if needed.
+	void	setMemoryBudget( size_t bytes );
+	//! Returns the number of bytes that loaded Buffer's may use.
+	size_t	getMemoryBudget() const;
+	//! Returns the number of threads used by preload().
+	size_t	getNumThreads() const	{ return mThreads.size(); }
+
+  private:
+	// canonical path (or DataSource address), samplerate, num channels
+	typedef std::tuple<std::string, size_t, size_t>		Key;
+	typedef std::shared_ptr<std::promise<BufferRef> >	PromiseRef;
+
+	struct Entry {
+		std::shared_future<BufferRef>	mFuture;
+		uint64_t						mLoadId;
+		bool							mLoaded;
+		size_t							mNumBytes;
+		std::list<Key>::iterator		mLruPos;	// valid once loaded
+		DataSourceRef					mDataSource;	// only for non-file sources, keeps the address in the key from being reused
+	};
+
+	struct Batch {
+		ProgressFn				mProgressFn;
+		size_t					mNumTotal;
+		std::atomic<size_t>		mNumFinished;
+	};
+
+	struct Task {
+		Key						mKey;
+		DataSourceRef			mDataSource;
+		std::shared_ptr<Batch>	mBatch;
+	};
+
+	Key								makeKey( const DataSourceRef &dataSource, size_t sampleRate, size_t numChannels ) const;
+	std::shared_future<BufferRef>	findOrBeginLoad( const Key &key, const DataSourceRef &dataSource, PromiseRef *promise, uint64_t *loadId );
+	void							performLoad( const Key &key, const DataSourceRef &dataSource, const PromiseRef &promise, uint64_t loadId );
+	void							removeEntry( std::map<Key, Entry>::iterator entryIt );
+	void							evictBuffers();
+	BufferRef						decode( const Key &key, const DataSourceRef &dataSource );
+	void							threadLoop();
+
+	std::map<Key, Entry>		mEntries;
+	std::list<Key>				mLru; // most recently used first
+	size_t						mNumBytes, mMemoryBudget;
+	uint64_t					mNextLoadId;
+	fs::path					mCacheDirectory;
+	CacheFormat					mCacheFormat;
+	mutable std::mutex			mMutex;
+
+	std::deque<Task>			mTasks;
+	std::vector<std::thread>	mThreads;
+	std::condition_variable		mTaskCondition;
+	bool						mQuit;
+};
+
+} } // namespace cinder::audio2
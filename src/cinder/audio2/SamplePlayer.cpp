@@ -26,11 +26,148 @@
 #include "cinder/audio2/Debug.h"
 #include "cinder/CinderMath.h"
 
+#include "r8brain/CDSPFracInterpolator.h"
+
 using namespace ci;
 using namespace std;
 
 namespace cinder { namespace audio2 {
 
+namespace {
+
+// how often FileReadScheduler's threads look for read requests. The audio thread requests a read once its ring buffer is half
+// empty, which is typically tens of milliseconds before an underrun.
+const chrono::milliseconds kReadPollInterval( 2 );
+
+atomic<size_t> sDefaultNumReadThreads( 2 );
+
+// Decodes up to dest->getNumFrames() frames from sourceFile, starting at position and reading through readBuffer.
+// Returns the number of frames decoded, which is less than requested if the end of the file was reached.
+size_t decodeFrames( SourceFile *sourceFile, size_t position, Buffer *dest, BufferDynamic *readBuffer )
+{
+	const size_t numFrames = dest->getNumFrames();
+	if( ! numFrames )
+		return 0;
+
+	sourceFile->seek( position );
+
+	size_t numDecoded = 0;
+	while( numDecoded < numFrames ) {
+		readBuffer->setNumFrames( min( numFrames - numDecoded, sourceFile->getMaxFramesPerRead() ) );
+		size_t numRead = sourceFile->read( readBuffer );
+		if( ! numRead )
+			break;
+
+		dest->copyOffset( *readBuffer, numRead, numDecoded, 0 );
+		numDecoded += numRead;
+	}
+
+	return numDecoded;
+}
+
+// same filter length and number of fractional positions as r8b::CDSPResampler24
+const int kSincFilterLength = 18;
+const int kSincFilterFracs = 137;
+
+typedef r8b::CDSPFracDelayFilterBank<kSincFilterLength, kSincFilterFracs, 3, 8> SincFilterBank;
+
+const SincFilterBank& getSincFilterBank()
+{
+	static SincFilterBank sFilterBank;
+	return sFilterBank;
+}
+
+// Gathers numPoints samples starting at pointsBefore frames before each read index into points, one channel per point, so that the
+// interpolation kernels can run over contiguous arrays. Indices at or past loopEnd wrap around to loopBegin and indices outside of
+// the buffer read as silence. Pass loopBegin = loopEnd to disable wrapping.
+void gatherPoints( const float *channel, size_t numFrames, size_t loopBegin, size_t loopEnd, const size_t *indices, size_t count, size_t pointsBefore, size_t numPoints, Buffer *points )
+{
+	const int64_t readEnd = loopEnd > loopBegin ? loopEnd : numFrames;
+	const int64_t loopLength = loopEnd - loopBegin;
+
+	for( size_t i = 0; i < count; i++ ) {
+		const int64_t first = int64_t( indices[i] ) - int64_t( pointsBefore );
+
+		if( first >= 0 && first + int64_t( numPoints ) <= readEnd ) {
+			for( size_t p = 0; p < numPoints; p++ )
+				points->getChannel( p )[i] = channel[first + p];
+		}
+		else {
+			for( size_t p = 0; p < numPoints; p++ ) {
+				int64_t index = first + p;
+				if( loopLength > 0 && index >= int64_t( loopEnd ) )
+					index = loopBegin + ( index - loopEnd ) % loopLength;
+
+				points->getChannel( p )[i] = ( index >= 0 && index < int64_t( numFrames ) ) ? channel[index] : 0;
+			}
+		}
+	}
+}
+
+void interpolateLinear( const Buffer &points, const float *fractions, float *dest, size_t count )
+{
+	const float *x0 = points.getChannel( 0 );
+	const float *x1 = points.getChannel( 1 );
+
+	for( size_t i = 0; i < count; i++ )
+		dest[i] = x0[i] + fractions[i] * ( x1[i] - x0[i] );
+}
+
+void interpolateCubic( const Buffer &points, const float *fractions, float *dest, size_t count )
+{
+	const float *xm1 = points.getChannel( 0 );
+	const float *x0 = points.getChannel( 1 );
+	const float *x1 = points.getChannel( 2 );
+	const float *x2 = points.getChannel( 3 );
+
+	for( size_t i = 0; i < count; i++ ) {
+		const float c1 = 0.5f * ( x1[i] - xm1[i] );
+		const float c2 = xm1[i] - 2.5f * x0[i] + 2 * x1[i] - 0.5f * x2[i];
+		const float c3 = 0.5f * ( x2[i] - xm1[i] ) + 1.5f * ( x0[i] - x1[i] );
+		const float t = fractions[i];
+
+		dest[i] = ( ( c3 * t + c2 ) * t + c1 ) * t + x0[i];
+	}
+}
+
+// Each filter in the bank is stored as kSincFilterLength taps of 3 coefficients, a 2nd order polynomial used to interpolate
+// between adjacent fractional positions. See r8b::CDSPFracInterpolator::process().
+void interpolateSinc( const Buffer &points, const float *fractions, float *dest, size_t count )
+{
+	const SincFilterBank &filterBank = getSincFilterBank();
+	const size_t kChunkSize = 64;
+
+	const double *filters[kChunkSize];
+	double x[kChunkSize], x2[kChunkSize], sums[kChunkSize];
+
+	for( size_t offset = 0; offset < count; offset += kChunkSize ) {
+		const size_t chunkSize = min( kChunkSize, count - offset );
+
+		for( size_t i = 0; i < chunkSize; i++ ) {
+			const double pos = fractions[offset + i] * kSincFilterFracs;
+			const int filterIndex = int( pos );
+
+			filters[i] = &filterBank[filterIndex];
+			x[i] = pos - filterIndex;
+			x2[i] = x[i] * x[i];
+			sums[i] = 0;
+		}
+
+		for( size_t p = 0; p < kSincFilterLength; p++ ) {
+			const float *samples = points.getChannel( p ) + offset;
+			for( size_t i = 0; i < chunkSize; i++ ) {
+				const double *tap = filters[i] + p * 3;
+				sums[i] += ( tap[0] + tap[1] * x[i] + tap[2] * x2[i] ) * samples[i];
+			}
+		}
+
+		for( size_t i = 0; i < chunkSize; i++ )
+			dest[offset + i] = float( sums[i] );
+	}
+}
+
+} // anonymous namespace
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - SamplePlayer
 // ----------------------------------------------------------------------------------------------------
@@ -94,12 +231,12 @@ size_t SamplePlayer::getNumSeconds() const
 // ----------------------------------------------------------------------------------------------------
 
 BufferPlayer::BufferPlayer( const Format &format )
-	: SamplePlayer( format )
+	: SamplePlayer( format ), mRate( this, 1 ), mInterpolation( Interpolation::CUBIC ), mReadFraction( 0 ), mLastReadPos( 0 )
 {
 }
 
 BufferPlayer::BufferPlayer( const BufferRef &buffer, const Format &format )
-	: SamplePlayer( format ), mBuffer( buffer )
+	: SamplePlayer( format ), mBuffer( buffer ), mRate( this, 1 ), mInterpolation( Interpolation::CUBIC ), mReadFraction( 0 ), mLastReadPos( 0 )
 {
 	mNumFrames = mLoopEnd = mBuffer->getNumFrames();
 
@@ -108,6 +245,18 @@ BufferPlayer::BufferPlayer( const BufferRef &buffer, const Format &format )
 	setNumChannels( mBuffer->getNumChannels() );
 }
 
+void BufferPlayer::initialize()
+{
+	const size_t framesPerBlock = getFramesPerBlock();
+
+	mReadIndices.resize( framesPerBlock );
+	mReadFractions.resize( framesPerBlock );
+	mInterpPoints.setSize( framesPerBlock, kSincFilterLength );
+
+	// computing the filter bank takes a while, make sure it doesn't happen on the audio thread
+	getSincFilterBank();
+}
+
 void BufferPlayer::start()
 {
 	if( ! mBuffer ) {
@@ -165,43 +314,157 @@ void BufferPlayer::loadBuffer( const SourceFileRef &sourceFile )
 }
 
 void BufferPlayer::process( Buffer *buffer )
+{
+	// a seek since the last block starts from a whole frame
+	if( mReadPos != mLastReadPos )
+		mReadFraction = 0;
+
+	if( mRate.eval() )
+		processVariableRate( buffer, mRate.getValueArray() );
+	else if( mRate.getValue() != 1 || mReadFraction != 0 )
+		processVariableRate( buffer, nullptr );
+	else
+		processUnityRate( buffer );
+
+	mLastReadPos = mReadPos;
+}
+
+void BufferPlayer::processUnityRate( Buffer *buffer )
 {
 	size_t readPos = mReadPos;
-	size_t numFrames = buffer->getNumFrames();
-	size_t readEnd = mLoop ? mLoopEnd.load() : mNumFrames;
-	size_t readCount = readEnd < readPos ? 0 : min( readEnd - readPos, numFrames );
+	const size_t numFrames = buffer->getNumFrames();
+
+	if( mLoop ) {
+		const size_t loopBegin = mLoopBegin;
+		const size_t loopEnd = mLoopEnd;
+
+		// an empty loop region plays silence
+		if( loopEnd <= loopBegin ) {
+			buffer->zero();
+			return;
+		}
+
+		// wrap around as many times as needed to fill the block, so the loop is sample-continuous
+		size_t writePos = 0;
+		while( writePos < numFrames ) {
+			if( readPos >= loopEnd )
+				readPos = loopBegin;
+
+			size_t readCount = min( loopEnd - readPos, numFrames - writePos );
+			buffer->copyOffset( *mBuffer, readCount, writePos, readPos );
+			writePos += readCount;
+			readPos += readCount;
+		}
+
+		mReadPos = readPos;
+		return;
+	}
+
+	size_t readCount = mNumFrames < readPos ? 0 : min( mNumFrames - readPos, numFrames );
 
 	buffer->copyOffset( *mBuffer, readCount, 0, readPos );
 
 	if( readCount < numFrames  ) {
-		// TODO: if looping, copy from mLoopBegin instead of zero'ing
 		buffer->zero( readCount, numFrames - readCount );
 
-		if( mLoop ) {
-			mReadPos.store( mLoopBegin );
-			return;
-		} else {
-			mIsEof = true;
-			mEnabled = false;
-		}
+		mIsEof = true;
+		mEnabled = false;
 	}
 
 	mReadPos += readCount;
 }
 
+// If rateArray is null, the rate is constant over the block.
+void BufferPlayer::processVariableRate( Buffer *buffer, const float *rateArray )
+{
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t loopBegin = mLoopBegin;
+	const size_t loopEnd = mLoopEnd;
+	const bool loop = mLoop;
+
+	// same as processUnityRate(), an empty loop region plays silence
+	if( loop && loopEnd <= loopBegin ) {
+		buffer->zero();
+		return;
+	}
+
+	const size_t numReadFrames = calcReadPositions( numFrames, rateArray );
+
+	const Interpolation interpolation = mInterpolation;
+	const size_t pointsBefore = interpolation == Interpolation::LINEAR ? 0 : ( interpolation == Interpolation::CUBIC ? 1 : kSincFilterLength / 2 - 1 );
+	const size_t numPoints = interpolation == Interpolation::LINEAR ? 2 : ( interpolation == Interpolation::CUBIC ? 4 : kSincFilterLength );
+
+	for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
+		gatherPoints( mBuffer->getChannel( ch ), mNumFrames, loop ? loopBegin : 0, loop ? loopEnd : 0, mReadIndices.data(), numReadFrames, pointsBefore, numPoints, &mInterpPoints );
+
+		float *channel = buffer->getChannel( ch );
+		if( interpolation == Interpolation::LINEAR )
+			interpolateLinear( mInterpPoints, mReadFractions.data(), channel, numReadFrames );
+		else if( interpolation == Interpolation::CUBIC )
+			interpolateCubic( mInterpPoints, mReadFractions.data(), channel, numReadFrames );
+		else
+			interpolateSinc( mInterpPoints, mReadFractions.data(), channel, numReadFrames );
+	}
+
+	if( numReadFrames < numFrames ) {
+		buffer->zero( numReadFrames, numFrames - numReadFrames );
+
+		mIsEof = true;
+		mEnabled = false;
+	}
+}
+
+// Fills mReadIndices and mReadFractions with the read position of each frame in the block, wrapping around the loop, and advances
+// the read position. Returns the number of frames to render, which is less than numFrames if the end of the buffer was reached.
+size_t BufferPlayer::calcReadPositions( size_t numFrames, const float *rateArray )
+{
+	const size_t loopBegin = mLoopBegin;
+	const size_t loopEnd = mLoopEnd;
+	const bool loop = mLoop;
+	const double readEnd = loop ? (double)loopEnd : (double)mNumFrames;
+	const double loopLength = double( loopEnd - loopBegin );
+	const float rate = max( mRate.getValue(), 0.0f );
+
+	double pos = (double)mReadPos + mReadFraction;
+	size_t i = 0;
+	for( ; i < numFrames; i++ ) {
+		if( pos >= readEnd ) {
+			if( ! loop )
+				break;
+
+			const double overshoot = pos - readEnd;
+			pos = loopBegin + ( overshoot < loopLength ? overshoot : 0 );
+		}
+
+		const size_t index = size_t( pos );
+		mReadIndices[i] = index;
+		mReadFractions[i] = float( pos - (double)index );
+
+		pos += rateArray ? max( rateArray[i], 0.0f ) : rate;
+	}
+
+	const size_t readPos = size_t( pos );
+	mReadFraction = pos - (double)readPos;
+	mReadPos = readPos;
+
+	return i;
+}
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - FilePlayer
 // ----------------------------------------------------------------------------------------------------
 
 FilePlayer::FilePlayer( const Format &format )
-	: SamplePlayer( format ), mRingBufferPaddingFactor( 2 )
+	: SamplePlayer( format ), mLoopCacheBegin( 0 ), mLoopCacheEnd( 0 ), mRingBufferPaddingFactor( 2 ), mReadRequested( false ), mReadInProgress( false ),
+		mSourceFileNeedsSeek( true ), mSeekPos( 0 ), mSeekRequested( false ), mIsReadAsync( true )
 {
 	// force channel mode to match buffer
 	mChannelMode = ChannelMode::SPECIFIED;
 }
 
 FilePlayer::FilePlayer( const SourceFileRef &sourceFile, bool isReadAsync, const Format &format )
-	: SamplePlayer( format ), mSourceFile( sourceFile ), mIsReadAsync( isReadAsync ), mRingBufferPaddingFactor( 2 )
+	: SamplePlayer( format ), mLoopCacheBegin( 0 ), mLoopCacheEnd( 0 ), mSourceFile( sourceFile ), mRingBufferPaddingFactor( 2 ), mReadRequested( false ),
+		mReadInProgress( false ), mSourceFileNeedsSeek( true ), mSeekPos( 0 ), mSeekRequested( false ), mIsReadAsync( isReadAsync )
 {
 	// force channel mode to match buffer
 	mChannelMode = ChannelMode::SPECIFIED;
@@ -213,7 +476,7 @@ FilePlayer::FilePlayer( const SourceFileRef &sourceFile, bool isReadAsync, const
 FilePlayer::~FilePlayer()
 {
 	if( mInitialized )
-		destroyReadThreadImpl();
+		removeFromReadScheduler();
 }
 
 void FilePlayer::initialize()
@@ -228,20 +491,30 @@ void FilePlayer::initialize()
 
 	mIoBuffer.setSize( mSourceFile->getMaxFramesPerRead(), mNumChannels );
 
-	for( size_t i = 0; i < mNumChannels; i++ )
-		mRingBuffers.emplace_back( mSourceFile->getMaxFramesPerRead() * mRingBufferPaddingFactor );
+	mRingBuffer.resize( mSourceFile->getMaxFramesPerRead() * mRingBufferPaddingFactor, mNumChannels );
+	mBufferFramesThreshold = mRingBuffer.getSize() / 2;
 
-	mBufferFramesThreshold = mRingBuffers[0].getSize() / 2;
+	// the samplerate may have changed, so the loop cache needs to be decoded again
+	mLoopCache.setSize( 0, mNumChannels );
+	mLoopCacheBegin = mLoopCacheEnd = 0;
+
+	// not yet registered with the FileReadScheduler, so it is safe to use mSourceFile here
+	for( auto &cuePoint : mCuePoints ) {
+		if( cuePoint.mSampleRate != getSampleRate() )
+			decodePreRoll( &cuePoint, mSourceFile.get() );
+	}
+
+	mSourceFileNeedsSeek = true;
 
 	if( mIsReadAsync ) {
-		mAsyncReadShouldQuit = false;
-		mReadThread = unique_ptr<thread>( new thread( bind( &FilePlayer::readAsyncImpl, this ) ) );
+		mReadScheduler = FileReadScheduler::get();
+		mReadScheduler->addPlayer( this );
 	}
 }
 
 void FilePlayer::uninitialize()
 {
-	destroyReadThreadImpl();
+	removeFromReadScheduler();
 }
 
 void FilePlayer::start()
@@ -252,7 +525,7 @@ void FilePlayer::start()
 	}
 
 	if( mStartAtBeginning )
-		seekImpl( 0 );
+		requestSeek( 0 );
 
 	mIsEof = false;
 	mEnabled = true;
@@ -270,13 +543,8 @@ void FilePlayer::seek( size_t readPositionFrames )
 		return;
 	}
 
-	// Synchronize with the mutex that protects the read thread, which is different depending on if
-	// read is async or sync (done on audio thread)
-	mutex &m = mIsReadAsync ? mAsyncReadMutex : getContext()->getMutex();
-	lock_guard<mutex> lock( m );
-
 	mIsEof = false;
-	seekImpl( readPositionFrames );
+	requestSeek( readPositionFrames );
 }
 
 void FilePlayer::setSourceFile( const SourceFileRef &sourceFile )
@@ -284,18 +552,31 @@ void FilePlayer::setSourceFile( const SourceFileRef &sourceFile )
 	// update source's samplerate to match context
 	sourceFile->setOutputFormat( getSampleRate(), sourceFile->getNumChannels() );
 
-	lock_guard<mutex> lock( getContext()->getMutex() );
+	bool enabled;
+	{
+		lock_guard<mutex> lock( getContext()->getMutex() );
 
-	bool enabled = mEnabled;
-	if( mEnabled )
-		stop();
+		enabled = mEnabled;
+		if( mEnabled )
+			stop();
 
-	if( mNumChannels != sourceFile->getNumChannels() ) {
-		setNumChannels( sourceFile->getNumChannels() );
-		configureConnections();
+		if( mNumChannels != sourceFile->getNumChannels() ) {
+			setNumChannels( sourceFile->getNumChannels() );
+			configureConnections();
+		}
 	}
 
+	// The read side owns the loop cache, so also synchronize with it. Its lock can be held for a whole disk read, so take
+	// it before the Context's mutex rather than waiting on it while the audio thread is locked out.
+	auto readSideLock = lockReadSide();
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
 	mSourceFile = sourceFile;
+	mLoopCache.setSize( 0, sourceFile->getNumChannels() );
+	mLoopCacheBegin = mLoopCacheEnd = 0;
+	mCuePoints.clear();
+	mSourceFileNeedsSeek = true;
+
 	mNumFrames = sourceFile->getNumFrames();
 
 	if( ! mLoopEnd  || mLoopEnd > mNumFrames )
@@ -305,6 +586,59 @@ void FilePlayer::setSourceFile( const SourceFileRef &sourceFile )
 		start();
 }
 
+void FilePlayer::addCuePoint( size_t positionFrames, double preRollSeconds )
+{
+	if( ! mSourceFile ) {
+		CI_LOG_E( "no source file, returning." );
+		return;
+	}
+
+	// decode from a clone of the SourceFile, so the read side isn't blocked meanwhile
+	auto sourceFile = mSourceFile->clone();
+	sourceFile->setOutputFormat( getSampleRate(), mSourceFile->getNumChannels() );
+
+	CuePoint cuePoint;
+	cuePoint.mPosition = min( positionFrames, sourceFile->getNumFrames() );
+	cuePoint.mPreRollSeconds = preRollSeconds;
+	decodePreRoll( &cuePoint, sourceFile.get() );
+
+	auto lock = lockCuePoints();
+
+	auto it = lower_bound( mCuePoints.begin(), mCuePoints.end(), cuePoint.mPosition, []( const CuePoint &a, size_t position ) { return a.mPosition < position; } );
+	if( it != mCuePoints.end() && it->mPosition == cuePoint.mPosition )
+		*it = move( cuePoint );
+	else
+		mCuePoints.insert( it, move( cuePoint ) );
+}
+
+void FilePlayer::addCuePointTime( double positionSeconds, double preRollSeconds )
+{
+	addCuePoint( size_t( positionSeconds * (double)getSampleRate() ), preRollSeconds );
+}
+
+void FilePlayer::removeCuePoint( size_t positionFrames )
+{
+	auto lock = lockCuePoints();
+
+	mCuePoints.erase( remove_if( mCuePoints.begin(), mCuePoints.end(), [positionFrames]( const CuePoint &cuePoint ) { return cuePoint.mPosition == positionFrames; } ), mCuePoints.end() );
+}
+
+void FilePlayer::clearCuePoints()
+{
+	auto lock = lockCuePoints();
+
+	mCuePoints.clear();
+}
+
+vector<size_t> FilePlayer::getCuePoints() const
+{
+	vector<size_t> result;
+	for( const auto &cuePoint : mCuePoints )
+		result.push_back( cuePoint.mPosition );
+
+	return result;
+}
+
 uint64_t FilePlayer::getLastUnderrun()
 {
 	uint64_t result = mLastUnderrun;
@@ -322,98 +656,326 @@ uint64_t FilePlayer::getLastOverrun()
 void FilePlayer::process( Buffer *buffer )
 {
 	size_t numFrames = buffer->getNumFrames();
-	size_t readPos = mReadPos;
-	size_t numReadAvail = mRingBuffers[0].getAvailableRead();
+
+	if( mSeekRequested.load( memory_order_acquire ) ) {
+		// Resetting the ring buffers requires the read side to be idle. When reading asynchronously and a read is
+		// in progress, output silence and try again next block rather than playing from the old position.
+		unique_lock<mutex> asyncReadLock( mAsyncReadMutex, defer_lock );
+		if( mIsReadAsync && ! asyncReadLock.try_lock() ) {
+			buffer->zero();
+			return;
+		}
+
+		// cleared before loading mSeekPos, so that a seek requested meanwhile is performed next block
+		mSeekRequested = false;
+		seekImpl( mSeekPos );
+	}
+
+	size_t numReadAvail = mRingBuffer.getAvailableRead();
 
 	if( numReadAvail < mBufferFramesThreshold ) {
 		if( mIsReadAsync )
-			mIssueAsyncReadCond.notify_one();
-		else
+			mReadScheduler->requestRead( this );
+		else {
 			readImpl();
+			numReadAvail = mRingBuffer.getAvailableRead();
+		}
 	}
 
 	size_t readCount = std::min( numReadAvail, numFrames );
 
-	for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
-		if( ! mRingBuffers[ch].read( buffer->getChannel( ch ), readCount ) )
-			mLastUnderrun = getContext()->getNumProcessedFrames();
-	}
+	if( ! mRingBuffer.read( buffer, readCount ) )
+		mLastUnderrun = getContext()->getNumProcessedFrames();
 
-	// zero any unused frames, handle loop or EOF
+	// zero any unused frames. The read side wraps around loops itself, so running out of samples is only an EOF when not looping.
 	if( readCount < numFrames ) {
-		// TODO: if looping, should fill with samples from the beginning of file
-		// - these should also already be in the ringbuffer, since a seek is done there as well. Rethink this path.
 		buffer->zero( readCount, numFrames - readCount );
 
-		readPos += readCount;
-		if( mLoop && readPos >= mLoopEnd )
-			seekImpl( mLoopBegin );
-		else if( readPos >= mNumFrames ) {
+		if( ! mLoop && mReadPos >= mNumFrames ) {
 			mIsEof = true;
 			mEnabled = false;
 		}
+		else
+			mLastUnderrun = getContext()->getNumProcessedFrames();
 	}
 }
 
+// called from one of FileReadScheduler's threads
 void FilePlayer::readAsyncImpl()
 {
-	size_t lastReadPos = mReadPos;
-	while( true ) {
-		unique_lock<mutex> lock( mAsyncReadMutex );
-		mIssueAsyncReadCond.wait( lock );
+	lock_guard<mutex> lock( mAsyncReadMutex );
+	readImpl();
+}
 
-		if( mAsyncReadShouldQuit )
-			return;
+// Fills the ring buffers from mReadPos, wrapping around the loop region. If \a cachedOnly is true, stops at the first
+// frame that isn't already decoded in memory, so that it never waits on the SourceFile.
+void FilePlayer::readImpl( bool cachedOnly )
+{
+	if( mLoop && ! cachedOnly )
+		updateLoopCache();
+
+	size_t availableWrite = mRingBuffer.getAvailableWrite();
+	if( ! availableWrite ) {
+		mLastOverrun = getContext()->getNumProcessedFrames();
+		return;
+	}
 
+	while( availableWrite ) {
 		size_t readPos = mReadPos;
-		if( readPos != lastReadPos )
-			mSourceFile->seek( readPos );
+		const size_t loopBegin = mLoopBegin;
+		const size_t loopEnd = mLoopEnd;
+		const bool loop = mLoop && loopBegin < loopEnd;
+		const size_t readEnd = loop ? loopEnd : mNumFrames;
+
+		if( readPos >= readEnd ) {
+			if( ! loop )
+				break;
+
+			// continue from the beginning of the loop in the same pass, so the ring buffer holds samples from both sides of the loop point
+			readPos = loopBegin;
+			mSourceFileNeedsSeek = true;
+		}
+
+		size_t numRead, cacheBegin;
+		const Buffer *cache = findCachedFrames( readPos, &cacheBegin );
+		if( cache ) {
+			// serve from memory, the SourceFile will need to seek past it once it is used again
+			size_t cacheEnd = min( cacheBegin + cache->getNumFrames(), readEnd );
+			numRead = min( availableWrite, cacheEnd - readPos );
+
+			mRingBuffer.write( *cache, numRead, readPos - cacheBegin );
+
+			mSourceFileNeedsSeek = true;
+		}
+		else if( cachedOnly )
+			break;
+		else {
+			if( mSourceFileNeedsSeek ) {
+				mSourceFileNeedsSeek = false;
+				mSourceFile->seek( readPos );
+			}
+
+			mIoBuffer.setNumFrames( min( availableWrite, readEnd - readPos ) );
+			numRead = mSourceFile->read( &mIoBuffer );
+			if( ! numRead )
+				break;
+
+			mRingBuffer.write( mIoBuffer, numRead );
+		}
 
-		readImpl();
-		lastReadPos = mReadPos;
+		mReadPos = readPos + numRead;
+		availableWrite -= numRead;
 	}
 }
 
-void FilePlayer::readImpl()
+void FilePlayer::requestSeek( size_t readPos )
 {
-	size_t readPos = mReadPos;
-	size_t availableWrite = mRingBuffers[0].getAvailableWrite();
-	size_t readEnd = mLoop ? mLoopEnd.load() : mNumFrames;
-	size_t numFramesToRead = readEnd < readPos ? 0 : min( availableWrite, readEnd - readPos );
+	mSeekPos = math<size_t>::clamp( readPos, 0, mNumFrames );
+	mSeekRequested.store( true, memory_order_release );
+}
 
-	if( ! numFramesToRead ) {
-		mLastOverrun = getContext()->getNumProcessedFrames();
+// Called from the audio thread while the read side is idle. Discards the samples buffered for the old position and, if
+// the new position is a cue point (or within the loop cache), immediately refills with its pre-roll.
+void FilePlayer::seekImpl( size_t readPos )
+{
+	mRingBuffer.clear();
+
+	mReadPos = readPos;
+	mSourceFileNeedsSeek = true;
+
+	readImpl( true );
+}
+
+// Keeps the first frames of the loop region decoded in mLoopCache, as many as the ring buffer can hold. When the read side
+// wraps around it copies these into the ring buffer and seeks the SourceFile past them, so the wrap itself never waits on
+// the file and the seek has a full ring buffer's worth of time to complete. Called from the read side.
+void FilePlayer::updateLoopCache()
+{
+	const size_t loopBegin = mLoopBegin;
+	const size_t loopEnd = mLoopEnd;
+	if( loopBegin == mLoopCacheBegin && loopEnd == mLoopCacheEnd )
 		return;
-	}
 
-	mIoBuffer.setNumFrames( numFramesToRead );
+	mLoopCacheBegin = loopBegin;
+	mLoopCacheEnd = loopEnd;
 
-	size_t numRead = mSourceFile->read( &mIoBuffer );
-	mReadPos += numRead;
+	size_t numFrames = loopEnd > loopBegin ? min( loopEnd - loopBegin, mRingBuffer.getSize() ) : 0;
+	mLoopCache.setSize( numFrames, mNumChannels );
+	mLoopCache.setNumFrames( decodeFrames( mSourceFile.get(), loopBegin, &mLoopCache, &mIoBuffer ) );
+	mSourceFileNeedsSeek = true;
+}
 
-	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
-		if( ! mRingBuffers[ch].write( mIoBuffer.getChannel( ch ), numRead ) ) {
-			mLastOverrun = getContext()->getNumProcessedFrames();
-			return;
+void FilePlayer::decodePreRoll( CuePoint *cuePoint, SourceFile *sourceFile )
+{
+	const size_t sampleRate = getSampleRate();
+	const size_t numFramesLeft = sourceFile->getNumFrames() - min( cuePoint->mPosition, sourceFile->getNumFrames() );
+	const size_t numFrames = min( size_t( cuePoint->mPreRollSeconds * (double)sampleRate ), numFramesLeft );
+
+	BufferDynamic readBuffer( sourceFile->getMaxFramesPerRead(), sourceFile->getNumChannels() );
+	cuePoint->mPreRoll.setSize( numFrames, sourceFile->getNumChannels() );
+	cuePoint->mPreRoll.setNumFrames( decodeFrames( sourceFile, cuePoint->mPosition, &cuePoint->mPreRoll, &readBuffer ) );
+	cuePoint->mSampleRate = sampleRate;
+}
+
+// Returns the decoded frames containing \a readPos and sets \a cacheBegin to the position of their first frame, or returns
+// null if \a readPos needs to be read from the SourceFile.
+const Buffer* FilePlayer::findCachedFrames( size_t readPos, size_t *cacheBegin ) const
+{
+	if( readPos >= mLoopCacheBegin && readPos < mLoopCacheBegin + mLoopCache.getNumFrames() ) {
+		*cacheBegin = mLoopCacheBegin;
+		return &mLoopCache;
+	}
+
+	for( const auto &cuePoint : mCuePoints ) {
+		if( readPos >= cuePoint.mPosition && readPos < cuePoint.mPosition + cuePoint.mPreRoll.getNumFrames() ) {
+			*cacheBegin = cuePoint.mPosition;
+			return &cuePoint.mPreRoll;
 		}
 	}
+
+	return nullptr;
 }
 
-void FilePlayer::seekImpl( size_t readPos )
+// Locks the read side when it is one of FileReadScheduler's threads. Otherwise the read side is the audio thread and the returned lock is empty.
+unique_lock<mutex> FilePlayer::lockReadSide()
+{
+	return mIsReadAsync ? unique_lock<mutex>( mAsyncReadMutex ) : unique_lock<mutex>();
+}
+
+// Locks out the readers of mCuePoints. When reading asynchronously the audio thread only touches them within seekImpl(), under a
+// try_lock() of mAsyncReadMutex, so the Context's mutex isn't needed and holding it while waiting on a disk read would stall the audio thread.
+unique_lock<mutex> FilePlayer::lockCuePoints()
 {
-	mReadPos = math<size_t>::clamp( readPos, 0, mNumFrames );
+	return mIsReadAsync ? unique_lock<mutex>( mAsyncReadMutex ) : unique_lock<mutex>( getContext()->getMutex() );
+}
+
+void FilePlayer::removeFromReadScheduler()
+{
+	if( mReadScheduler ) {
+		mReadScheduler->removePlayer( this );
+		mReadScheduler.reset();
+	}
+}
+
+size_t FilePlayer::calcFramesUntilUnderrun() const
+{
+	return mRingBuffer.getAvailableRead();
+}
 
-	// if async mode, readAsyncImpl() will notice mReadPos was updated and do the seek there.
-	if( ! mIsReadAsync )
-		mSourceFile->seek( mReadPos );
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FileReadScheduler
+// ----------------------------------------------------------------------------------------------------
+
+FileReadSchedulerRef FileReadScheduler::get()
+{
+	static mutex sMutex;
+	static weak_ptr<FileReadScheduler> sScheduler;
+
+	lock_guard<mutex> lock( sMutex );
+
+	FileReadSchedulerRef result = sScheduler.lock();
+	if( ! result ) {
+		result = FileReadSchedulerRef( new FileReadScheduler( sDefaultNumReadThreads ) );
+		sScheduler = result;
+	}
+
+	return result;
+}
+
+void FileReadScheduler::setDefaultNumThreads( size_t numThreads )
+{
+	CI_ASSERT( numThreads > 0 );
+	sDefaultNumReadThreads = numThreads;
+}
+
+FileReadScheduler::FileReadScheduler( size_t numThreads )
+	: mQuit( false )
+{
+	for( size_t i = 0; i < numThreads; i++ )
+		mThreads.emplace_back( &FileReadScheduler::threadLoop, this );
 }
 
-void FilePlayer::destroyReadThreadImpl()
+FileReadScheduler::~FileReadScheduler()
 {
-	if( mIsReadAsync && mReadThread ) {
-		mAsyncReadShouldQuit = true;
-		mIssueAsyncReadCond.notify_one();
-		mReadThread->join();
+	{
+		lock_guard<mutex> lock( mMutex );
+		mQuit = true;
+	}
+
+	mCond.notify_all();
+	for( auto &t : mThreads )
+		t.join();
+}
+
+void FileReadScheduler::addPlayer( FilePlayer *player )
+{
+	lock_guard<mutex> lock( mMutex );
+	mPlayers.push_back( player );
+}
+
+void FileReadScheduler::removePlayer( FilePlayer *player )
+{
+	unique_lock<mutex> lock( mMutex );
+	mPlayers.erase( remove( mPlayers.begin(), mPlayers.end(), player ), mPlayers.end() );
+
+	// once removed the player can't be picked up again, but a thread may still be reading for it
+	mCond.wait( lock, [player] { return ! player->mReadInProgress; } );
+	player->mReadRequested = false;
+}
+
+void FileReadScheduler::requestRead( FilePlayer *player )
+{
+	player->mReadRequested.store( true, memory_order_release );
+}
+
+// Returns the requested player with the least audio left to play, skipping those already being read by another thread. Expects mMutex to be held.
+// All players run at their Context's samplerate, so buffered frames compare directly. This must not touch a player's SourceFile, which
+// setSourceFile() may be replacing.
+FilePlayer* FileReadScheduler::findMostUrgentRequest() const
+{
+	FilePlayer *result = nullptr;
+	size_t resultFrames = 0;
+
+	for( FilePlayer *player : mPlayers ) {
+		if( player->mReadInProgress || ! player->mReadRequested.load( memory_order_acquire ) )
+			continue;
+
+		size_t frames = player->calcFramesUntilUnderrun();
+		if( ! result || frames < resultFrames ) {
+			result = player;
+			resultFrames = frames;
+		}
+	}
+
+	return result;
+}
+
+void FileReadScheduler::threadLoop()
+{
+	while( true ) {
+		FilePlayer *player = nullptr;
+		{
+			unique_lock<mutex> lock( mMutex );
+
+			// the audio thread doesn't notify, so requests are polled for. Notifications only come from other threads finishing a read or quitting.
+			mCond.wait_for( lock, kReadPollInterval, [&] { return mQuit || ( player = findMostUrgentRequest() ) != nullptr; } );
+			if( mQuit )
+				return;
+			if( ! player )
+				continue;
+
+			player->mReadRequested = false;
+			player->mReadInProgress = true;
+		}
+
+		player->readAsyncImpl();
+
+		{
+			lock_guard<mutex> lock( mMutex );
+			player->mReadInProgress = false;
+		}
+
+		mCond.notify_all();
 	}
 }
 
@@ -30,12 +30,14 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <vector>
 
 namespace cinder { namespace audio2 {
 
 typedef std::shared_ptr<class SamplePlayer>				SamplePlayerRef;
 typedef std::shared_ptr<class BufferPlayer>				BufferPlayerRef;
 typedef std::shared_ptr<class FilePlayer>				FilePlayerRef;
+typedef std::shared_ptr<class FileReadScheduler>		FileReadSchedulerRef;
 
 //! \brief Base Node class for sampled audio playback. Can do operations like seek and loop.
 //! \note SamplePlayer itself doesn't process any audio, but contains the common interface for Node's that do.
@@ -49,7 +51,7 @@ class SamplePlayer : public NodeInput {
 
 	//! Seek to read position \a readPositionSeconds,
 	void seekToTime( double positionSeconds );
-	//! Returns the current read position in frames.
+	//! Returns the current read position in frames. \note FilePlayer performs seek() on the audio thread, so a seek is only reflected after the next processed block.
 	size_t getReadPosition() const	{ return mReadPos; }
 	//! Returns the current read position in seconds.
 	double getReadPositionTime() const;
@@ -95,9 +97,19 @@ class SamplePlayer : public NodeInput {
 	bool				mStartAtBeginning;
 };
 
-//! Buffer-based sample player. In other words, all samples are loaded into memory before playback.
+//! \brief Buffer-based sample player. In other words, all samples are loaded into memory before playback.
+//!
+//! The playback rate can be varied with setRate() or getParamRate(), which changes both speed and pitch. Rates other than 1 are rendered
+//! by interpolating the buffer, so one loaded buffer can be played back at any pitch.
 class BufferPlayer : public SamplePlayer {
   public:
+	//! Interpolation used when the playback rate isn't 1, in increasing order of quality and cost.
+	enum class Interpolation {
+		LINEAR,		//!< 2-point linear interpolation.
+		CUBIC,		//!< 4-point, 3rd order Hermite interpolation.
+		SINC		//!< 18-point windowed sinc interpolation, using r8brain's fractional delay filter bank. \note Rates above 1 are not additionally band-limited.
+	};
+
 	//! Constructs a BufferPlayer without a buffer, with the assumption one will be set later. \note Format::channels() can still be used to allocate the expected channel count ahead of time.
 	BufferPlayer( const Format &format = Format() );
 	//! Constructs a BufferPlayer with \a buffer. \note Channel mode is always ChannelMode::SPECIFIED and num channels matches \a buffer. Format::channels() is ignored.
@@ -115,10 +127,71 @@ class BufferPlayer : public SamplePlayer {
 	void setBuffer( const BufferRef &buffer );
 	const BufferRef& getBuffer() const	{ return mBuffer; }
 
+	//! Sets the playback rate, where 1 is the original speed, 2 is twice as fast and an octave higher, and so on. Negative rates are treated as 0 (default = 1).
+	void	setRate( float rate )		{ mRate.setValue( rate ); }
+	//! Returns the playback rate. \see setRate()
+	float	getRate() const				{ return mRate.getValue(); }
+	//! Returns the Param associated with the playback rate. \see setRate()
+	Param*	getParamRate()				{ return &mRate; }
+
+	//! Sets the interpolation used when the playback rate isn't 1 (default = Interpolation::CUBIC).
+	void			setInterpolation( Interpolation interpolation )	{ mInterpolation = interpolation; }
+	//! Returns the interpolation used when the playback rate isn't 1.
+	Interpolation	getInterpolation() const						{ return mInterpolation; }
+
   protected:
+	void initialize()						override;
 	virtual void process( Buffer *buffer )	override;
 
-	BufferRef mBuffer;
+	void	processUnityRate( Buffer *buffer );
+	void	processVariableRate( Buffer *buffer, const float *rateArray );
+	size_t	calcReadPositions( size_t numFrames, const float *rateArray );
+
+	BufferRef					mBuffer;
+	Param						mRate;
+	std::atomic<Interpolation>	mInterpolation;
+
+	double						mReadFraction;		// fractional part of the read position, non-zero only after playing at a rate other than 1
+	size_t						mLastReadPos;		// mReadPos as of the end of the last block, used to detect seeks
+	std::vector<size_t>			mReadIndices;		// integer part of the read position for each frame in the block
+	std::vector<float>			mReadFractions;		// fractional part of the read position for each frame in the block
+	BufferDynamic				mInterpPoints;		// samples surrounding each read position, one channel per interpolation point
+};
+
+//! \brief Pool of threads that read from disk on behalf of all FilePlayer's that read asynchronously.
+//!
+//! The audio thread requests a read by setting an atomic flag on the FilePlayer, so it never blocks or wakes a thread. The pool polls for requests
+//! and services the players that are closest to an underrun first, in other words those with the fewest seconds of audio left in their ring buffers.
+class FileReadScheduler {
+  public:
+	//! Returns the shared scheduler, creating it (and starting its threads) if no FilePlayer currently holds a reference to it.
+	static FileReadSchedulerRef get();
+	//! Sets the number of threads used by schedulers created after this call (default = 2).
+	static void setDefaultNumThreads( size_t numThreads );
+
+	~FileReadScheduler();
+
+	//! Returns the number of threads servicing read requests.
+	size_t getNumThreads() const	{ return mThreads.size(); }
+
+	//! Adds \a player to the set of players that are serviced.
+	void addPlayer( FilePlayer *player );
+	//! Removes \a player, blocking until any read in progress for it has completed.
+	void removePlayer( FilePlayer *player );
+	//! Requests a read for \a player, safe to call from the audio thread.
+	void requestRead( FilePlayer *player );
+
+  private:
+	FileReadScheduler( size_t numThreads );
+
+	void		threadLoop();
+	FilePlayer*	findMostUrgentRequest() const;
+
+	std::vector<std::thread>	mThreads;
+	std::vector<FilePlayer *>	mPlayers;
+	std::mutex					mMutex;
+	std::condition_variable		mCond;
+	bool						mQuit;
 };
 
 class FilePlayer : public SamplePlayer {
@@ -130,14 +203,28 @@ class FilePlayer : public SamplePlayer {
 
 	virtual void start() override;
 	virtual void stop() override;
+	//! Requests a seek to \a readPositionFrames, which the audio thread performs at the start of the next processed block (or a later one, while an
+	//! asynchronous read is in progress). getReadPosition() returns the old position until then.
 	virtual void seek( size_t readPositionFrames ) override;
 
 	bool isReadAsync() const	{ return mIsReadAsync; }
 
-	//! \note \a sourceFile's samplerate is forced to match this Node's Context.
+	//! \note \a sourceFile's samplerate is forced to match this Node's Context. Removes all cue points.
 	void setSourceFile( const SourceFileRef &sourceFile );
 	const SourceFileRef& getSourceFile() const	{ return mSourceFile; }
 
+	//! Adds a cue point at \a positionFrames, decoding the first \a preRollSeconds of audio from it into memory. start() or seek() to a cue point
+	//! plays immediately from the pre-roll while the file is streamed from after it. Adding a cue point at an existing position replaces it.
+	void addCuePoint( size_t positionFrames, double preRollSeconds = 0.5 );
+	//! Adds a cue point at \a positionSeconds, decoding the first \a preRollSeconds of audio from it into memory. \see addCuePoint()
+	void addCuePointTime( double positionSeconds, double preRollSeconds = 0.5 );
+	//! Removes the cue point at \a positionFrames, if there is one.
+	void removeCuePoint( size_t positionFrames );
+	//! Removes all cue points.
+	void clearCuePoints();
+	//! Returns the positions of all cue points in frames, in ascending order.
+	std::vector<size_t> getCuePoints() const;
+
 	//! Returns the frame of the last buffer underrun or 0 if none since the last time this method was called.
 	uint64_t getLastUnderrun();
 	//! Returns the frame of the last buffer overrun or 0 if none since the last time this method was called.
@@ -148,22 +235,44 @@ class FilePlayer : public SamplePlayer {
 	void uninitialize()				override;
 	void process( Buffer *buffer )	override;
 
+	struct CuePoint {
+		size_t			mPosition, mSampleRate;
+		double			mPreRollSeconds;
+		BufferDynamic	mPreRoll;
+	};
+
 	void readAsyncImpl();
-	void readImpl();
+	void readImpl( bool cachedOnly = false );
 	void seekImpl( size_t readPos );
-	void destroyReadThreadImpl();
-
-	std::vector<dsp::RingBuffer>				mRingBuffers;	// used to transfer samples from io to audio thread, one ring buffer per channel
+	void requestSeek( size_t readPos );
+	void updateLoopCache();
+	void decodePreRoll( CuePoint *cuePoint, SourceFile *sourceFile );
+	const Buffer* findCachedFrames( size_t readPos, size_t *cacheBegin ) const;
+	std::unique_lock<std::mutex> lockReadSide();
+	std::unique_lock<std::mutex> lockCuePoints();
+	void removeFromReadScheduler();
+	size_t calcFramesUntilUnderrun() const;
+
+	dsp::MultiChannelRingBuffer					mRingBuffer;	// used to transfer samples from io to audio thread
 	BufferDynamic								mIoBuffer;		// used to read samples from the file on read thread, resizeable so the ringbuffer can be filled
+	BufferDynamic								mLoopCache;		// decoded frames at the start of the loop, so wrapping around never waits on the file
+	size_t										mLoopCacheBegin, mLoopCacheEnd;	// loop region mLoopCache was filled for, only accessed from the read side
+	std::vector<CuePoint>						mCuePoints;		// sorted by position, modified under lockCuePoints()
 
 	SourceFileRef								mSourceFile;
 	size_t										mBufferFramesThreshold, mRingBufferPaddingFactor;
 	std::atomic<uint64_t>						mLastUnderrun, mLastOverrun;
 
-	std::unique_ptr<std::thread>				mReadThread;
+	FileReadSchedulerRef						mReadScheduler;
 	std::mutex									mAsyncReadMutex;
-	std::condition_variable						mIssueAsyncReadCond;
-	bool										mIsReadAsync, mAsyncReadShouldQuit;
+	std::atomic<bool>							mReadRequested;
+	bool										mReadInProgress;	// guarded by the FileReadScheduler's mutex
+	std::atomic<bool>							mSourceFileNeedsSeek;	// set when mReadPos no longer matches the SourceFile's read position
+	std::atomic<size_t>							mSeekPos;
+	std::atomic<bool>							mSeekRequested;			// seeks are performed on the audio thread, see process()
+	bool										mIsReadAsync;
+
+	friend class FileReadScheduler;
 };
 
 } } // namespace cinder::audio2
\ No newline at end of file
@@ -0,0 +1,276 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio2/SampleStore.h"
+#include "cinder/audio2/FileOggVorbis.h"
+#include "cinder/audio2/Exception.h"
+#include "cinder/audio2/Debug.h"
+
+using namespace std;
+
+namespace cinder { namespace audio2 {
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SourceFileStored
+// ----------------------------------------------------------------------------------------------------
+
+//! SourceFile that reads a sound held by a SampleStore, decoding whole blocks that are shared through the store's cache.
+class SourceFileStored : public SourceFile {
+  public:
+	SourceFileStored( const SampleStoreRef &store, const shared_ptr<SampleStore::Entry> &entry );
+
+	SourceFileRef	clone() const	override;
+
+	size_t		performRead( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded )		override;
+	void		performSeek( size_t readPositionFrames )											override;
+	std::string getMetaData() const																	override	{ return mDecoder->getMetaData(); }
+
+  private:
+	BufferRef	decodeBlock( size_t blockIndex );
+
+	SampleStoreRef						mStore;
+	shared_ptr<SampleStore::Entry>		mEntry;
+	unique_ptr<SourceFileImplOggVorbis>	mDecoder;
+	size_t								mNativeReadPos, mDecoderReadPos;
+};
+
+SourceFileStored::SourceFileStored( const SampleStoreRef &store, const shared_ptr<SampleStore::Entry> &entry )
+	: SourceFile(), mStore( store ), mEntry( entry ), mNativeReadPos( 0 ), mDecoderReadPos( 0 )
+{
+	mDecoder.reset( new SourceFileImplOggVorbis( DataSourceBuffer::create( mEntry->mEncodedData ) ) );
+	mDecoder->setMaxFramesPerRead( SampleStore::kBlockFrames );
+
+	mSampleRate = mNativeSampleRate = mDecoder->getNativeSampleRate();
+	mNumChannels = mNativeNumChannels = mDecoder->getNativeNumChannels();
+	mNumFrames = mFileNumFrames = mDecoder->getNumFrames();
+}
+
+SourceFileRef SourceFileStored::clone() const
+{
+	return make_shared<SourceFileStored>( mStore, mEntry );
+}
+
+size_t SourceFileStored::performRead( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded )
+{
+	CI_ASSERT( buffer->getNumFrames() >= bufferFrameOffset + numFramesNeeded );
+
+	size_t readCount = 0;
+	while( readCount < numFramesNeeded && mNativeReadPos < mFileNumFrames ) {
+		size_t blockIndex = mNativeReadPos / SampleStore::kBlockFrames;
+		size_t blockOffset = mNativeReadPos % SampleStore::kBlockFrames;
+
+		auto key = make_pair( mEntry->mId, blockIndex );
+		BufferRef block = mStore->findBlock( key );
+		if( ! block )
+			block = mStore->insertBlock( key, decodeBlock( blockIndex ) );
+
+		size_t numFrames = min( block->getNumFrames() - blockOffset, numFramesNeeded - readCount );
+		for( size_t ch = 0; ch < mNativeNumChannels; ch++ )
+			memcpy( buffer->getChannel( ch ) + bufferFrameOffset + readCount, block->getChannel( ch ) + blockOffset, numFrames * sizeof( float ) );
+
+		readCount += numFrames;
+		mNativeReadPos += numFrames;
+	}
+
+	return readCount;
+}
+
+void SourceFileStored::performSeek( size_t readPositionFrames )
+{
+	// the decoder is only repositioned when a block that isn't cached is needed
+	mNativeReadPos = readPositionFrames;
+}
+
+BufferRef SourceFileStored::decodeBlock( size_t blockIndex )
+{
+	size_t blockBegin = blockIndex * SampleStore::kBlockFrames;
+	auto result = make_shared<Buffer>( min( SampleStore::kBlockFrames, mFileNumFrames - blockBegin ), mNativeNumChannels );
+
+	if( mDecoderReadPos != blockBegin )
+		mDecoder->seek( blockBegin );
+
+	// Ogg Vorbis reads until the buffer is full, so anything missing is past the real end of the stream and is left as silence.
+	size_t numRead = mDecoder->read( result.get() );
+	mDecoderReadPos = blockBegin + numRead;
+
+	return result;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SampleStore
+// ----------------------------------------------------------------------------------------------------
+
+const size_t SampleStore::kBlockFrames;
+
+// static
+SampleStoreRef SampleStore::create( size_t decodedCacheCapacityBytes )
+{
+	return SampleStoreRef( new SampleStore( decodedCacheCapacityBytes ) );
+}
+
+SampleStore::SampleStore( size_t decodedCacheCapacityBytes )
+	: mNumDecodedBytes( 0 ), mDecodedCacheCapacity( decodedCacheCapacityBytes ), mNextEntryId( 0 )
+{
+}
+
+void SampleStore::add( const std::string &key, const DataSourceRef &dataSource )
+{
+	auto entry = make_shared<Entry>();
+	entry->mEncodedData = dataSource->getBuffer();
+
+	// opening the data throws if it isn't Ogg Vorbis, before anything is stored
+	SourceFileImplOggVorbis probe( DataSourceBuffer::create( entry->mEncodedData ) );
+
+	lock_guard<mutex> lock( mMutex );
+
+	entry->mId = mNextEntryId++;
+
+	auto existing = mEntries.find( key );
+	if( existing != mEntries.end() )
+		removeBlocks( existing->second->mId );
+
+	mEntries[key] = entry;
+}
+
+void SampleStore::remove( const std::string &key )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	auto existing = mEntries.find( key );
+	if( existing == mEntries.end() )
+		return;
+
+	removeBlocks( existing->second->mId );
+	mEntries.erase( existing );
+}
+
+bool SampleStore::contains( const std::string &key ) const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mEntries.count( key ) != 0;
+}
+
+SourceFileRef SampleStore::createSourceFile( const std::string &key )
+{
+	shared_ptr<Entry> entry;
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		auto existing = mEntries.find( key );
+		if( existing == mEntries.end() )
+			throw AudioExc( "no sound stored under key: " + key );
+
+		entry = existing->second;
+	}
+
+	return make_shared<SourceFileStored>( shared_from_this(), entry );
+}
+
+size_t SampleStore::getNumEncodedBytes() const
+{
+	lock_guard<mutex> lock( mMutex );
+
+	size_t result = 0;
+	for( const auto &entry : mEntries )
+		result += entry.second->mEncodedData.getDataSize();
+
+	return result;
+}
+
+size_t SampleStore::getNumDecodedBytes() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mNumDecodedBytes;
+}
+
+void SampleStore::setDecodedCacheCapacity( size_t bytes )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	mDecodedCacheCapacity = bytes;
+	evictBlocks( mDecodedCacheCapacity );
+}
+
+size_t SampleStore::getDecodedCacheCapacity() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mDecodedCacheCapacity;
+}
+
+BufferRef SampleStore::findBlock( const BlockKey &key )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	auto indexIt = mBlockIndex.find( key );
+	if( indexIt == mBlockIndex.end() )
+		return BufferRef();
+
+	mBlocks.splice( mBlocks.begin(), mBlocks, indexIt->second );
+	return indexIt->second->mBlock;
+}
+
+BufferRef SampleStore::insertBlock( const BlockKey &key, const BufferRef &block )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	// another reader may have decoded the same block in the meantime, in which case that one is kept.
+	auto indexIt = mBlockIndex.find( key );
+	if( indexIt != mBlockIndex.end() ) {
+		mBlocks.splice( mBlocks.begin(), mBlocks, indexIt->second );
+		return indexIt->second->mBlock;
+	}
+
+	CachedBlock cached = { key, block };
+	mBlocks.push_front( cached );
+	mBlockIndex[key] = mBlocks.begin();
+	mNumDecodedBytes += block->getSize() * sizeof( float );
+
+	// readers hold their own reference, so a block can be evicted even while it is still being copied from.
+	evictBlocks( mDecodedCacheCapacity );
+	return block;
+}
+
+void SampleStore::removeBlocks( uint64_t entryId )
+{
+	for( auto blockIt = mBlocks.begin(); blockIt != mBlocks.end(); ) {
+		if( blockIt->mKey.first == entryId ) {
+			mNumDecodedBytes -= blockIt->mBlock->getSize() * sizeof( float );
+			mBlockIndex.erase( blockIt->mKey );
+			blockIt = mBlocks.erase( blockIt );
+		}
+		else
+			++blockIt;
+	}
+}
+
+void SampleStore::evictBlocks( size_t capacity )
+{
+	while( mNumDecodedBytes > capacity && ! mBlocks.empty() ) {
+		const CachedBlock &oldest = mBlocks.back();
+		mNumDecodedBytes -= oldest.mBlock->getSize() * sizeof( float );
+		mBlockIndex.erase( oldest.mKey );
+		mBlocks.pop_back();
+	}
+}
+
+} } // namespace cinder::audio2
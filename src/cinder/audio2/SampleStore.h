@@ -0,0 +1,100 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio2/Source.h"
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <cstdint>
+
+namespace cinder { namespace audio2 {
+
+typedef std::shared_ptr<class SampleStore>		SampleStoreRef;
+
+//! \brief Keeps Ogg Vorbis files in memory in their encoded form and hands out SourceFile's that decode them on demand.
+//!
+//! A stored sound costs about its encoded size, roughly a tenth of the float samples that SourceFile::loadBuffer() would return.
+//! SourceFile's returned from createSourceFile() decode in blocks of kBlockFrames, which are kept in a least-recently-used cache
+//! shared by all of them, so sounds that are played often are only decoded once while they remain in the cache. Play them with an
+//! asynchronous FilePlayer so that decoding happens on the FileReadScheduler's threads, into the player's ring buffers.
+class SampleStore : public std::enable_shared_from_this<SampleStore>, public boost::noncopyable {
+  public:
+	//! Creates a new SampleStore whose decoded block cache uses at most \a decodedCacheCapacityBytes.
+	static SampleStoreRef create( size_t decodedCacheCapacityBytes = 16 * 1024 * 1024 );
+
+	//! Stores the encoded contents of \a dataSource under \a key, replacing any sound already stored there. Throws AudioFileExc if \a dataSource is not an Ogg Vorbis file.
+	void add( const std::string &key, const DataSourceRef &dataSource );
+	//! Removes the sound stored under \a key, along with its decoded blocks. SourceFile's already created from it remain valid.
+	void remove( const std::string &key );
+	//! Returns whether a sound is stored under \a key.
+	bool contains( const std::string &key ) const;
+	//! Returns a new SourceFile that decodes the sound stored under \a key from memory. Throws AudioExc if there is no such sound.
+	SourceFileRef createSourceFile( const std::string &key );
+
+	//! Returns the total number of encoded bytes held in memory.
+	size_t	getNumEncodedBytes() const;
+	//! Returns the number of bytes currently held by decoded blocks.
+	size_t	getNumDecodedBytes() const;
+	//! Sets the maximum number of bytes held by decoded blocks, evicting the least recently used blocks if needed.
+	void	setDecodedCacheCapacity( size_t bytes );
+	//! Returns the maximum number of bytes held by decoded blocks.
+	size_t	getDecodedCacheCapacity() const;
+
+	//! The number of frames decoded at once, which is also the granularity of the decoded block cache.
+	static const size_t kBlockFrames = 8192;
+
+  private:
+	SampleStore( size_t decodedCacheCapacityBytes );
+
+	struct Entry {
+		ci::Buffer	mEncodedData;
+		uint64_t	mId;
+	};
+
+	// entry id, block index
+	typedef std::pair<uint64_t, size_t>	BlockKey;
+
+	struct CachedBlock {
+		BlockKey	mKey;
+		BufferRef	mBlock;
+	};
+
+	BufferRef	findBlock( const BlockKey &key );
+	BufferRef	insertBlock( const BlockKey &key, const BufferRef &block );
+	void		removeBlocks( uint64_t entryId );
+	void		evictBlocks( size_t capacity );
+
+	std::map<std::string, std::shared_ptr<Entry> >					mEntries;
+	std::list<CachedBlock>											mBlocks; // most recently used first
+	std::map<BlockKey, std::list<CachedBlock>::iterator>			mBlockIndex;
+	size_t															mNumDecodedBytes, mDecodedCacheCapacity;
+	uint64_t														mNextEntryId;
+	mutable std::mutex												mMutex;
+
+	friend class SourceFileStored;
+};
+
+} } // namespace cinder::audio2
@@ -0,0 +1,311 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio2/Sampler.h"
+#include "cinder/audio2/Context.h"
+#include "cinder/CinderMath.h"
+
+using namespace ci;
+using namespace std;
+
+namespace cinder { namespace audio2 {
+
+namespace {
+
+const size_t kInvalidSlot = size_t( -1 );
+
+} // anonymous namespace
+
+Sampler::Sampler( const BufferRef &buffer, const Format &format )
+	: NodeInput( format ), mBuffer( buffer ), mNumVoices( max<size_t>( format.getNumVoices(), 1 ) ), mStealMode( format.getStealMode() ),
+		mFadeSeconds( format.getFadeSeconds() ), mFadeFrames( 1 ), mCommandQueue( max<size_t>( format.getNumVoices() * 2, 64 ) ), mNextVoiceId( 1 ),
+		mNumActiveVoices( 0 ), mStartCounter( 0 )
+{
+	mChannelMode = ChannelMode::SPECIFIED;
+	setNumChannels( 2 );
+
+	const size_t numSlots = mNumVoices * 2;
+
+	mStates.resize( numSlots, VoiceState::FREE );
+	mIds.resize( numSlots, 0 );
+	mPriorities.resize( numSlots, 0 );
+	mStartOrders.resize( numSlots, 0 );
+	mPositions.resize( numSlots, 0 );
+	mRates.resize( numSlots, 1 );
+	mGains.resize( numSlots, 0 );
+	mPans.resize( numSlots, 0.5f );
+	mEnvelopes.resize( numSlots, 0 );
+	mEnvelopeDeltas.resize( numSlots, 0 );
+	mEnvelopeFrames.resize( numSlots, 0 );
+}
+
+void Sampler::initialize()
+{
+	mFadeFrames = max<int32_t>( int32_t( mFadeSeconds * (float)getSampleRate() ), 1 );
+}
+
+uint32_t Sampler::trigger( float gain, float pan, float rate, int priority )
+{
+	lock_guard<mutex> lock( mCommandMutex );
+
+	const uint32_t voiceId = mNextVoiceId++;
+	if( ! mNextVoiceId )
+		mNextVoiceId = 1;
+
+	const Command command = { CommandType::TRIGGER, voiceId, gain, math<float>::clamp( pan ), max( rate, 0.0f ), priority };
+	pushCommand( command );
+
+	return voiceId;
+}
+
+void Sampler::release( uint32_t voiceId )
+{
+	lock_guard<mutex> lock( mCommandMutex );
+
+	const Command command = { CommandType::RELEASE, voiceId, 0, 0, 0, 0 };
+	pushCommand( command );
+}
+
+void Sampler::releaseAll()
+{
+	lock_guard<mutex> lock( mCommandMutex );
+
+	const Command command = { CommandType::RELEASE_ALL, 0, 0, 0, 0, 0 };
+	pushCommand( command );
+}
+
+void Sampler::setBuffer( const BufferRef &buffer )
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	mBuffer = buffer;
+	fill( mStates.begin(), mStates.end(), VoiceState::FREE );
+	mNumActiveVoices = 0;
+}
+
+void Sampler::process( Buffer *buffer )
+{
+	processCommands();
+
+	buffer->zero();
+
+	float *left = buffer->getChannel( 0 );
+	float *right = buffer->getChannel( 1 );
+	const size_t numFrames = buffer->getNumFrames();
+
+	size_t numActiveVoices = 0;
+	for( size_t slot = 0; slot < mStates.size(); slot++ ) {
+		if( mStates[slot] == VoiceState::FREE )
+			continue;
+
+		renderVoice( slot, left, right, numFrames );
+
+		if( mStates[slot] == VoiceState::PLAYING )
+			numActiveVoices++;
+	}
+
+	mNumActiveVoices = numActiveVoices;
+}
+
+void Sampler::pushCommand( const Command &command )
+{
+	mCommandQueue.push( command, getContext()->getMutex(), [this] { processCommands(); } );
+}
+
+void Sampler::processCommands()
+{
+	Command command;
+	while( mCommandQueue.pop( &command ) ) {
+
+		switch( command.mType ) {
+			case CommandType::TRIGGER:
+				startVoice( command );
+				break;
+			case CommandType::RELEASE:
+				for( size_t slot = 0; slot < mStates.size(); slot++ ) {
+					if( mStates[slot] == VoiceState::PLAYING && mIds[slot] == command.mVoiceId ) {
+						releaseVoice( slot, mFadeFrames );
+						break;
+					}
+				}
+				break;
+			case CommandType::RELEASE_ALL:
+				for( size_t slot = 0; slot < mStates.size(); slot++ ) {
+					if( mStates[slot] == VoiceState::PLAYING )
+						releaseVoice( slot, mFadeFrames );
+				}
+				break;
+			default:
+				CI_ASSERT_NOT_REACHABLE();
+		}
+	}
+}
+
+void Sampler::startVoice( const Command &command )
+{
+	const size_t numPlaying = count( mStates.begin(), mStates.end(), VoiceState::PLAYING );
+	if( numPlaying >= mNumVoices ) {
+		size_t victim = findVictim( command.mPriority );
+		if( victim == kInvalidSlot )
+			return;
+
+		releaseVoice( victim, mFadeFrames );
+	}
+
+	size_t slot = findFreeSlot();
+	if( slot == kInvalidSlot ) {
+		// every slot is either playing or fading out, so cut short the quietest of the fading voices
+		for( size_t i = 0; i < mStates.size(); i++ ) {
+			if( mStates[i] == VoiceState::RELEASING && ( slot == kInvalidSlot || mEnvelopes[i] < mEnvelopes[slot] ) )
+				slot = i;
+		}
+	}
+
+	CI_ASSERT( slot != kInvalidSlot );
+
+	mStates[slot] = VoiceState::PLAYING;
+	mIds[slot] = command.mVoiceId;
+	mPriorities[slot] = command.mPriority;
+	mStartOrders[slot] = mStartCounter++;
+	mPositions[slot] = 0;
+	mRates[slot] = command.mRate;
+	mGains[slot] = command.mGain;
+	mPans[slot] = command.mPan;
+	mEnvelopes[slot] = 1;
+	mEnvelopeDeltas[slot] = 0;
+	mEnvelopeFrames[slot] = 0;
+}
+
+void Sampler::releaseVoice( size_t slot, int32_t fadeFrames )
+{
+	mStates[slot] = VoiceState::RELEASING;
+	mEnvelopeFrames[slot] = fadeFrames;
+	mEnvelopeDeltas[slot] = -mEnvelopes[slot] / float( fadeFrames );
+}
+
+// Returns the playing voice to steal according to mStealMode, or kInvalidSlot if the new voice should be dropped.
+size_t Sampler::findVictim( int priority ) const
+{
+	size_t result = kInvalidSlot;
+	if( mStealMode == StealMode::NONE )
+		return result;
+
+	for( size_t slot = 0; slot < mStates.size(); slot++ ) {
+		if( mStates[slot] != VoiceState::PLAYING )
+			continue;
+
+		if( mStealMode == StealMode::LOWEST_PRIORITY ) {
+			if( mPriorities[slot] > priority )
+				continue;
+
+			if( result == kInvalidSlot || mPriorities[slot] < mPriorities[result] || ( mPriorities[slot] == mPriorities[result] && mStartOrders[slot] < mStartOrders[result] ) )
+				result = slot;
+		}
+		else if( result == kInvalidSlot || mStartOrders[slot] < mStartOrders[result] )
+			result = slot;
+	}
+
+	return result;
+}
+
+size_t Sampler::findFreeSlot() const
+{
+	auto it = find( mStates.begin(), mStates.end(), VoiceState::FREE );
+	return it != mStates.end() ? size_t( it - mStates.begin() ) : kInvalidSlot;
+}
+
+// Mixes the voice in slot into left and right, with linear interpolation when its rate isn't 1. Mono buffers are panned with equal power,
+// stereo buffers the same way as Pan2d does for stereo input.
+void Sampler::renderVoice( size_t slot, float *left, float *right, size_t count )
+{
+	const size_t numFrames = mBuffer->getNumFrames();
+	const bool isStereo = mBuffer->getNumChannels() > 1;
+	const float *channel0 = mBuffer->getChannel( 0 );
+	const float *channel1 = isStereo ? mBuffer->getChannel( 1 ) : channel0;
+
+	// output = ( s0 * a + s1 * b, s0 * c + s1 * d ), where s0 and s1 are the voice's left and right samples
+	const float pan = mPans[slot];
+	const float gain = mGains[slot];
+	const float leftGain = math<float>::cos( pan * float( M_PI / 2.0 ) ) * gain;
+	const float rightGain = math<float>::sin( pan * float( M_PI / 2.0 ) ) * gain;
+	float a, b, c, d;
+	if( isStereo ) {
+		const float centerGain = math<float>::cos( float( M_PI / 4.0 ) ) * gain;
+		a = leftGain;
+		b = pan < 0.5f ? leftGain - centerGain : 0;
+		c = pan < 0.5f ? 0 : rightGain - centerGain;
+		d = rightGain;
+	}
+	else {
+		// s1 equals s0, so only its coefficients are used
+		a = leftGain;
+		b = 0;
+		c = rightGain;
+		d = 0;
+	}
+
+	const double rate = mRates[slot];
+	double pos = mPositions[slot];
+	float envelope = mEnvelopes[slot];
+	const float envelopeDelta = mEnvelopeDeltas[slot];
+	int32_t envelopeFrames = mEnvelopeFrames[slot];
+
+	bool finished = false;
+	for( size_t i = 0; i < count; i++ ) {
+		const size_t index = size_t( pos );
+		if( index >= numFrames ) {
+			finished = true;
+			break;
+		}
+
+		// the sample after the last one is treated as silence
+		const float frac = float( pos - (double)index );
+		const bool hasNext = index + 1 < numFrames;
+		const float s0 = channel0[index] + frac * ( ( hasNext ? channel0[index + 1] : 0 ) - channel0[index] );
+		const float s1 = channel1[index] + frac * ( ( hasNext ? channel1[index + 1] : 0 ) - channel1[index] );
+
+		left[i] += ( s0 * a + s1 * b ) * envelope;
+		right[i] += ( s0 * c + s1 * d ) * envelope;
+
+		pos += rate;
+
+		if( envelopeFrames > 0 ) {
+			envelope += envelopeDelta;
+			if( --envelopeFrames == 0 && mStates[slot] == VoiceState::RELEASING ) {
+				finished = true;
+				break;
+			}
+		}
+	}
+
+	if( finished ) {
+		mStates[slot] = VoiceState::FREE;
+		return;
+	}
+
+	mPositions[slot] = pos;
+	mEnvelopes[slot] = envelope;
+	mEnvelopeFrames[slot] = envelopeFrames;
+}
+
+} } // namespace cinder::audio2
@@ -0,0 +1,143 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio2/NodeInput.h"
+#include "cinder/audio2/dsp/RingBuffer.h"
+
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+namespace cinder { namespace audio2 {
+
+typedef std::shared_ptr<class Sampler>		SamplerRef;
+
+//! \brief Polyphonic, one-shot playback of a Buffer, with per-voice rate, gain and pan.
+//!
+//! Voices are kept in a fixed pool in structure-of-arrays layout and are all rendered and mixed to a stereo output in one pass, which
+//! is far cheaper than a BufferPlayer, Gain and Pan2d per voice. When all voices are playing, trigger() steals one according to the
+//! Format's StealMode. Stolen and released voices fade out over Format::fadeSeconds, so neither clicks.
+class Sampler : public NodeInput {
+  public:
+	//! Determines which voice is stolen when trigger() is called while all voices are playing.
+	enum class StealMode {
+		//! The new voice is dropped.
+		NONE,
+		//! The voice that was triggered first is stolen.
+		OLDEST,
+		//! The voice with the lowest priority is stolen, the oldest of those if there are several. If all voices have a higher priority than the new one, it is dropped.
+		LOWEST_PRIORITY
+	};
+
+	struct Format : public Node::Format {
+		Format() : mNumVoices( 32 ), mStealMode( StealMode::OLDEST ), mFadeSeconds( 0.005f ) {}
+
+		//! Sets the maximum number of voices that play at once (default = 32).
+		Format&		numVoices( size_t numVoices )		{ mNumVoices = numVoices; return *this; }
+		//! Sets how voices are stolen (default = StealMode::OLDEST).
+		Format&		stealMode( StealMode mode )			{ mStealMode = mode; return *this; }
+		//! Sets the length of the fade out when a voice is released or stolen (default = 0.005 seconds).
+		Format&		fadeSeconds( float seconds )		{ mFadeSeconds = seconds; return *this; }
+
+		size_t		getNumVoices() const		{ return mNumVoices; }
+		StealMode	getStealMode() const		{ return mStealMode; }
+		float		getFadeSeconds() const		{ return mFadeSeconds; }
+
+	  protected:
+		size_t		mNumVoices;
+		StealMode	mStealMode;
+		float		mFadeSeconds;
+	};
+
+	//! Constructs a Sampler that plays \a buffer, which can be mono or stereo (further channels are ignored). The output is always stereo.
+	Sampler( const BufferRef &buffer, const Format &format = Format() );
+
+	//! Starts a new voice and returns its id. \a pan ranges from 0 (left) to 1 (right) and \a rate is the playback rate, where 1 is the original
+	//! speed and pitch. Voices start at the beginning of the next processing block. If the voice is dropped (see StealMode), its id is simply never used.
+	uint32_t	trigger( float gain = 1, float pan = 0.5f, float rate = 1, int priority = 0 );
+	//! Fades out the voice with id \a voiceId, if it is still playing.
+	void		release( uint32_t voiceId );
+	//! Fades out all voices.
+	void		releaseAll();
+
+	//! Replaces the Buffer, stopping all voices immediately.
+	void				setBuffer( const BufferRef &buffer );
+	const BufferRef&	getBuffer() const			{ return mBuffer; }
+
+	//! Returns the maximum number of voices that play at once.
+	size_t		getNumVoices() const			{ return mNumVoices; }
+	//! Returns the number of voices that were playing (not counting those fading out) as of the last processing block.
+	size_t		getNumActiveVoices() const		{ return mNumActiveVoices; }
+	StealMode	getStealMode() const			{ return mStealMode; }
+
+  protected:
+	void initialize() override;
+	void process( Buffer *buffer ) override;
+
+  private:
+	enum class CommandType { TRIGGER, RELEASE, RELEASE_ALL };
+
+	struct Command {
+		CommandType	mType;
+		uint32_t	mVoiceId;
+		float		mGain, mPan, mRate;
+		int			mPriority;
+	};
+
+	enum class VoiceState : uint8_t { FREE, PLAYING, RELEASING };
+
+	void	pushCommand( const Command &command );
+	void	processCommands();
+	void	startVoice( const Command &command );
+	void	releaseVoice( size_t slot, int32_t fadeFrames );
+	size_t	findVictim( int priority ) const;
+	size_t	findFreeSlot() const;
+	void	renderVoice( size_t slot, float *left, float *right, size_t count );
+
+	BufferRef	mBuffer;
+	size_t		mNumVoices;
+	StealMode	mStealMode;
+	float		mFadeSeconds;
+	int32_t		mFadeFrames;
+
+	// user thread
+	std::mutex					mCommandMutex;	// serializes producers of mCommandQueue, never taken by the audio thread
+	dsp::CommandQueueT<Command>	mCommandQueue;
+	uint32_t					mNextVoiceId;
+	std::atomic<size_t>			mNumActiveVoices;
+
+	// audio thread. There are twice as many slots as voices, so that a stolen voice can fade out while its replacement starts.
+	std::vector<VoiceState>		mStates;
+	std::vector<uint32_t>		mIds;
+	std::vector<int>			mPriorities;
+	std::vector<uint64_t>		mStartOrders;
+	std::vector<double>			mPositions;
+	std::vector<float>			mRates, mGains, mPans;
+	std::vector<float>			mEnvelopes, mEnvelopeDeltas;
+	std::vector<int32_t>		mEnvelopeFrames;
+	uint64_t					mStartCounter;
+};
+
+} } // namespace cinder::audio2
@@ -24,6 +24,7 @@
 #include "cinder/audio2/Scope.h"
 #include "cinder/audio2/dsp/RingBuffer.h"
 #include "cinder/audio2/dsp/Fft.h"
+#include "cinder/audio2/dsp/Yin.h"
 #include "cinder/audio2/Utilities.h"
 #include "cinder/audio2/Debug.h"
 
@@ -56,19 +57,15 @@ void Scope::initialize()
 	else if( ! isPowerOf2( mWindowSize ) )
 		mWindowSize = nextPowerOf2( static_cast<uint32_t>( mWindowSize ) );
 
-	for( size_t ch = 0; ch < mNumChannels; ch++ )
-		mRingBuffers.emplace_back( mWindowSize * mRingBufferPaddingFactor );
+	mRingBuffer.resize( mWindowSize * mRingBufferPaddingFactor, mNumChannels );
 
 	mCopiedBuffer = Buffer( mWindowSize, getNumChannels() );
 }
 
 void Scope::process( Buffer *buffer )
 {
-	size_t numFrames = min( buffer->getNumFrames(), mRingBuffers[0].getSize() );
-	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
-		if( ! mRingBuffers[ch].write( buffer->getChannel( ch ), numFrames ) )
-			return;
-	}
+	size_t numFrames = min( buffer->getNumFrames(), mRingBuffer.getSize() );
+	mRingBuffer.write( *buffer, numFrames );
 }
 
 const Buffer& Scope::getBuffer()
@@ -91,10 +88,7 @@ float Scope::getVolume( size_t channel )
 
 void Scope::fillCopiedBuffer()
 {
-	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
-		if( ! mRingBuffers[ch].read( mCopiedBuffer.getChannel( ch ), mCopiedBuffer.getNumFrames() ) )
-			return;
-	}
+	mRingBuffer.read( &mCopiedBuffer, mCopiedBuffer.getNumFrames() );
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -183,4 +177,130 @@ float ScopeSpectral::getFreqForBin( size_t bin )
 	return bin * getSampleRate() / (float)getFftSize();
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ScopePitch
+// ----------------------------------------------------------------------------------------------------
+
+ScopePitch::ScopePitch( const Format &format )
+	: NodeAutoPullable( format ), mWindowSize( format.getWindowSize() ), mHopSize( format.getHopSize() ), mHistoryPos( 0 ), mHopPos( 0 ),
+		mThreshold( format.getThreshold() ), mMinFreq( format.getMinFreq() ), mMaxFreq( format.getMaxFreq() )
+{
+	if( boost::indeterminate( format.getAutoEnable() ) )
+		setAutoEnabled();
+}
+
+ScopePitch::~ScopePitch()
+{
+}
+
+void ScopePitch::initialize()
+{
+	mDetectors.clear();
+	mEstimateBuffers.clear();
+
+	const float sampleRate = (float)getSampleRate();
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		unique_ptr<dsp::Yin> detector( new dsp::Yin( mWindowSize ) );
+		detector->setThreshold( mThreshold );
+
+		size_t minPeriod = mMaxFreq > 0 ? size_t( sampleRate / mMaxFreq ) : 0;
+		size_t maxPeriod = mMinFreq > 0 ? size_t( ceil( sampleRate / mMinFreq ) ) : detector->getWindowSize();
+		detector->setPeriodRange( minPeriod, maxPeriod );
+
+		mDetectors.push_back( move( detector ) );
+		mEstimateBuffers.emplace_back( 4 );
+	}
+
+	// the detector rounds up to a power of two, keep the history in sync with it.
+	mWindowSize = mDetectors.front()->getWindowSize();
+	if( ! mHopSize || mHopSize > mWindowSize )
+		mHopSize = mWindowSize / 4;
+
+	Estimate unvoiced = { 0, 0 };
+	mEstimates.assign( mNumChannels, unvoiced );
+	mHistory = Buffer( mWindowSize, mNumChannels );
+	mAnalysisBuffer = Buffer( mWindowSize );
+	mHistoryPos = 0;
+	mHopPos = 0;
+}
+
+void ScopePitch::uninitialize()
+{
+	mDetectors.clear();
+	mEstimateBuffers.clear();
+}
+
+void ScopePitch::process( Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+
+	// copy the block into the history in chunks that end on hop boundaries, analyzing each time a hop completes.
+	size_t readPos = 0;
+	while( readPos < numFrames ) {
+		size_t count = min( numFrames - readPos, min( mHopSize - mHopPos, mWindowSize - mHistoryPos ) );
+
+		for( size_t ch = 0; ch < mNumChannels; ch++ )
+			memcpy( mHistory.getChannel( ch ) + mHistoryPos, buffer->getChannel( ch ) + readPos, count * sizeof( float ) );
+
+		readPos += count;
+		mHopPos += count;
+		mHistoryPos += count;
+		if( mHistoryPos == mWindowSize )
+			mHistoryPos = 0;
+
+		if( mHopPos == mHopSize ) {
+			mHopPos = 0;
+			analyze();
+		}
+	}
+}
+
+void ScopePitch::analyze()
+{
+	const float sampleRate = (float)getSampleRate();
+	const size_t tailSize = mWindowSize - mHistoryPos;
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		// mHistoryPos points at the oldest frame, unwrap the history so it reads from oldest to newest.
+		const float *history = mHistory.getChannel( ch );
+		float *window = mAnalysisBuffer.getData();
+		memcpy( window, history + mHistoryPos, tailSize * sizeof( float ) );
+		memcpy( window + tailSize, history, mHistoryPos * sizeof( float ) );
+
+		float period = mDetectors[ch]->detectPeriod( window );
+
+		Estimate estimate;
+		estimate.mFreq = period > 0 ? sampleRate / period : 0;
+		estimate.mConfidence = mDetectors[ch]->getConfidence();
+
+		// if the reader has fallen behind, drop this estimate rather than block.
+		mEstimateBuffers[ch].write( &estimate, 1 );
+	}
+}
+
+void ScopePitch::updateEstimates()
+{
+	for( size_t ch = 0; ch < mEstimateBuffers.size(); ch++ ) {
+		dsp::RingBufferT<Estimate> &estimateBuffer = mEstimateBuffers[ch];
+		while( estimateBuffer.getAvailableRead() )
+			estimateBuffer.read( &mEstimates[ch], 1 );
+	}
+}
+
+float ScopePitch::getFreq( size_t channel )
+{
+	CI_ASSERT( channel < mEstimates.size() );
+
+	updateEstimates();
+	return mEstimates[channel].mFreq;
+}
+
+float ScopePitch::getConfidence( size_t channel )
+{
+	CI_ASSERT( channel < mEstimates.size() );
+
+	updateEstimates();
+	return mEstimates[channel].mConfidence;
+}
+
 } } // namespace cinder::audio2
\ No newline at end of file
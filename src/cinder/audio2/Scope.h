@@ -33,10 +33,12 @@ namespace cinder { namespace audio2 {
 
 namespace dsp {
 	class Fft;
+	class Yin;
 }
 
 typedef std::shared_ptr<class Scope> ScopeRef;
 typedef std::shared_ptr<class ScopeSpectral> ScopeSpectralRef;
+typedef std::shared_ptr<class ScopePitch> ScopePitchRef;
 
 //!	\brief Node for retrieving time-domain audio PCM samples.
 //!
@@ -82,7 +84,7 @@ class Scope : public NodeAutoPullable {
 	//! Copies audio frames from the RingBuffer into mCopiedBuffer, which is suitable for operation on the main thread.
 	void fillCopiedBuffer();
 	
-	std::vector<dsp::RingBuffer>	mRingBuffers;	// one per channel
+	dsp::MultiChannelRingBuffer		mRingBuffer;
 	Buffer							mCopiedBuffer;	// used to safely read audio frames on a non-audio thread
 	size_t							mWindowSize;
 	size_t							mRingBufferPaddingFactor;
@@ -140,4 +142,70 @@ class ScopeSpectral : public Scope {
 	float						mSmoothingFactor;
 };
 
+//!	\brief Node that tracks the fundamental frequency (pitch) of each of its input channels.
+//!
+//! Analysis is performed on the audio thread with a dsp::Yin detector per channel. A new estimate is made every hop, which can be smaller
+//! than the window so that results update faster than the lowest trackable period. Results are published through a lock-free dsp::RingBufferT
+//! and are safe to read from a single user thread, for example within update() or draw().
+//!
+//! This Node does not modify the incoming Buffer in its process() function and does not need to be connected to a NodeOutput.
+class ScopePitch : public NodeAutoPullable {
+  public:
+	struct Format : public Node::Format {
+		Format() : mWindowSize( 2048 ), mHopSize( 0 ), mThreshold( 0.15f ), mMinFreq( 0 ), mMaxFreq( 0 ) {}
+
+		//! Sets the analysis window size, rounded up to the nearest power of two. The lowest trackable frequency is sampleRate / ( windowSize / 2 ). Default is 2048.
+		Format& windowSize( size_t size )		{ mWindowSize = size; return *this; }
+		//! Sets the number of samples between successive estimates. Default is a quarter of the window size.
+		Format& hopSize( size_t size )			{ mHopSize = size; return *this; }
+		//! Sets the aperiodicity threshold (0 - 1, default = 0.15). Lower values reject noisier frames. \see dsp::Yin::setThreshold()
+		Format& threshold( float threshold )	{ mThreshold = threshold; return *this; }
+		//! Limits the search to frequencies between \a minFreq and \a maxFreq (in hertz). Narrowing the range reduces octave errors. Default is the full range allowed by the window size.
+		Format& freqRange( float minFreq, float maxFreq )	{ mMinFreq = minFreq; mMaxFreq = maxFreq; return *this; }
+
+		size_t	getWindowSize() const			{ return mWindowSize; }
+		size_t	getHopSize() const				{ return mHopSize; }
+		float	getThreshold() const			{ return mThreshold; }
+		float	getMinFreq() const				{ return mMinFreq; }
+		float	getMaxFreq() const				{ return mMaxFreq; }
+
+	  protected:
+		size_t	mWindowSize, mHopSize;
+		float	mThreshold, mMinFreq, mMaxFreq;
+	};
+
+	ScopePitch( const Format &format = Format() );
+	virtual ~ScopePitch();
+
+	//! Returns the most recently detected frequency of \a channel in hertz, or 0 if the signal was unvoiced. \note Only safe to call from one non-audio thread.
+	float	getFreq( size_t channel = 0 );
+	//! Returns the confidence (0 - 1) of the most recent estimate for \a channel. \note Only safe to call from one non-audio thread.
+	float	getConfidence( size_t channel = 0 );
+	//! Returns the analysis window size.
+	size_t	getWindowSize() const	{ return mWindowSize; }
+	//! Returns the number of samples between successive estimates.
+	size_t	getHopSize() const		{ return mHopSize; }
+
+  protected:
+	void initialize()				override;
+	void uninitialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	struct Estimate {
+		float mFreq, mConfidence;
+	};
+
+	void analyze();
+	void updateEstimates();
+
+	std::vector<std::unique_ptr<dsp::Yin> >		mDetectors;			// one per channel
+	std::vector<dsp::RingBufferT<Estimate> >	mEstimateBuffers;	// one per channel, written on the audio thread
+	std::vector<Estimate>						mEstimates;			// latest estimates, read on the user thread
+	Buffer										mHistory;			// circular buffer holding the last mWindowSize frames
+	Buffer										mAnalysisBuffer;	// mHistory in chronological order
+	size_t										mWindowSize, mHopSize, mHistoryPos, mHopPos;
+	float										mThreshold, mMinFreq, mMaxFreq;
+};
+
 } } // namespace cinder::audio2
\ No newline at end of file
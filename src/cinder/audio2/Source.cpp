@@ -28,6 +28,8 @@
 
 #include "cinder/Utilities.h"
 
+#include <thread>
+
 #if defined( CINDER_COCOA )
 	#include "cinder/audio2/cocoa/FileCoreAudio.h"
 #elif defined( CINDER_MSW )
@@ -38,6 +40,27 @@ using namespace std;
 
 namespace cinder { namespace audio2 {
 
+namespace {
+
+// Segments loaded in parallel begin decoding this many source frames before their first frame, which gives the decoder and the
+// samplerate converter's filters time to settle.
+const size_t kSegmentPreRollFrames = 8192;
+// Files are only split so that each segment has at least this many source frames, shorter ones load faster on one thread.
+const size_t kMinSegmentFrames = 262144;
+
+size_t greatestCommonDivisor( size_t a, size_t b )
+{
+	while( b ) {
+		size_t t = a % b;
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
+
+} // anonymous namespace
+
 Source::Source()
 	: mNativeSampleRate( 0 ), mNativeNumChannels( 0 ), mSampleRate( 0 ), mNumChannels( 0 ), mMaxFramesPerRead( 4096 )
 {
@@ -107,8 +130,18 @@ size_t SourceFile::read( Buffer *buffer )
 	return numRead;
 }
 
-BufferRef SourceFile::loadBuffer()
+BufferRef SourceFile::loadBuffer( size_t numThreads )
 {
+	if( ! numThreads )
+		numThreads = max<size_t>( 1, thread::hardware_concurrency() );
+
+	// Segments are read in the native format and converted with their own dsp::Converter, so implementations that convert
+	// internally are loaded serially unless the output format is native.
+	bool nativeFormat = mSampleRate == mNativeSampleRate && mNumChannels == mNativeNumChannels;
+	size_t numSegments = min( numThreads, mFileNumFrames / kMinSegmentFrames );
+	if( numSegments > 1 && ( nativeFormat || ! supportsConversion() ) )
+		return loadBufferSegmented( numSegments );
+
 	seek( 0 );
 
 	BufferRef result = make_shared<Buffer>( mNumFrames, mNumChannels );
@@ -144,6 +177,101 @@ BufferRef SourceFile::loadBuffer()
 	return result;
 }
 
+BufferRef SourceFile::loadBufferSegmented( size_t numSegments )
+{
+	BufferRef result = make_shared<Buffer>( mNumFrames, mNumChannels );
+
+	// Segments begin on source frames that land exactly on an output frame, so that a converter started there produces frames at
+	// the same positions as one that started at the beginning of the file. Without samplerate conversion, every frame qualifies.
+	size_t divisor = greatestCommonDivisor( mNativeSampleRate, mSampleRate );
+	size_t sourceGrid = mNativeSampleRate / divisor;
+	size_t outputGrid = mSampleRate / divisor;
+	size_t preRollFrames = ( ( kSegmentPreRollFrames + sourceGrid - 1 ) / sourceGrid ) * sourceGrid;
+
+	vector<size_t> boundaries( numSegments + 1 );
+	for( size_t i = 0; i < numSegments; i++ )
+		boundaries[i] = size_t( (uint64_t)mFileNumFrames * i / numSegments / sourceGrid * sourceGrid );
+
+	boundaries[numSegments] = mFileNumFrames;
+
+	// clones are made up front, as SourceFile's aren't safe to clone from multiple threads.
+	vector<SourceFileRef> segmentFiles;
+	for( size_t i = 0; i < numSegments; i++ )
+		segmentFiles.push_back( clone() );
+
+	vector<exception_ptr> errors( numSegments );
+	auto loadFn = [&]( size_t i ) {
+		try {
+			loadSegment( segmentFiles[i].get(), result.get(), boundaries[i], boundaries[i + 1], preRollFrames, sourceGrid, outputGrid );
+		}
+		catch( ... ) {
+			errors[i] = current_exception();
+		}
+	};
+
+	// the first segment is loaded on this thread
+	vector<thread> threads;
+	for( size_t i = 1; i < numSegments; i++ )
+		threads.emplace_back( loadFn, i );
+
+	loadFn( 0 );
+
+	for( auto &t : threads )
+		t.join();
+
+	for( const auto &error : errors ) {
+		if( error )
+			rethrow_exception( error );
+	}
+
+	mReadPos = mNumFrames;
+	return result;
+}
+
+// Decodes source frames [segmentBegin, segmentEnd) with segmentFile, converting them into the matching output frames of dest.
+// Any output frames produced before the segment or after it (while the converter catches up) are discarded.
+void SourceFile::loadSegment( SourceFile *segmentFile, Buffer *dest, size_t segmentBegin, size_t segmentEnd, size_t preRollFrames, size_t sourceGrid, size_t outputGrid ) const
+{
+	size_t readPos = segmentBegin - min( segmentBegin, preRollFrames );
+	size_t outputPos = readPos / sourceGrid * outputGrid;
+	size_t destBegin = segmentBegin / sourceGrid * outputGrid;
+	size_t destEnd = segmentEnd == mFileNumFrames ? mNumFrames : segmentEnd / sourceGrid * outputGrid;
+
+	BufferDynamic readBuffer( mMaxFramesPerRead, mNativeNumChannels );
+	unique_ptr<dsp::Converter> converter;
+	Buffer converterDestBuffer;
+	if( mConverter ) {
+		converter = dsp::Converter::create( mNativeSampleRate, mSampleRate, mNativeNumChannels, mNumChannels, mMaxFramesPerRead );
+		converterDestBuffer = Buffer( converter->getDestMaxFramesPerBlock(), mNumChannels );
+	}
+
+	segmentFile->performSeek( readPos );
+
+	while( outputPos < destEnd && readPos < mFileNumFrames ) {
+		readBuffer.setNumFrames( min( mMaxFramesPerRead, mFileNumFrames - readPos ) );
+		size_t numRead = segmentFile->performRead( &readBuffer, 0, readBuffer.getNumFrames() );
+		if( ! numRead )
+			break;
+
+		readPos += numRead;
+
+		const Buffer *output = &readBuffer;
+		size_t numOutput = numRead;
+		if( converter ) {
+			readBuffer.setNumFrames( numRead );
+			numOutput = converter->convert( &readBuffer, &converterDestBuffer ).second;
+			output = &converterDestBuffer;
+		}
+
+		size_t copyBegin = max( outputPos, destBegin );
+		size_t copyEnd = min( outputPos + numOutput, destEnd );
+		if( copyBegin < copyEnd )
+			dest->copyOffset( *output, copyEnd - copyBegin, copyBegin, copyBegin - outputPos );
+
+		outputPos += numOutput;
+	}
+}
+
 void SourceFile::seek( size_t readPositionFrames )
 {
 	if( readPositionFrames >= mNumFrames )
@@ -92,7 +92,12 @@ class SourceFile : public Source {
 	virtual SourceFileRef clone() const = 0;
 
 	//! Loads and returns the entire contents of this SourceFile. \return a BufferRef containing the file contents.
-	BufferRef loadBuffer();
+	//!
+	//! If \a numThreads is greater than one (or zero, which uses one thread per core), long files are split into segments that are
+	//! each decoded and converted on their own thread, from a clone() of this SourceFile. Each segment starts decoding a little
+	//! early so that the decoder and samplerate converter have settled before its first frame. Implementations that provide their own
+	//! conversion are always loaded on one thread when the output format differs from the native one.
+	BufferRef loadBuffer( size_t numThreads = 1 );
 	//! Seek the read position to \a readPositionFrames
 	void seek( size_t readPositionFrames );
 	//! Seek to read position \a readPositionSeconds
@@ -110,6 +115,10 @@ class SourceFile : public Source {
 	virtual void performSeek( size_t readPositionFrames ) = 0;
 
 	size_t mNumFrames, mFileNumFrames, mReadPos;
+
+  private:
+	BufferRef	loadBufferSegmented( size_t numSegments );
+	void		loadSegment( SourceFile *segmentFile, Buffer *dest, size_t segmentBegin, size_t segmentEnd, size_t preRollFrames, size_t sourceGrid, size_t outputGrid ) const;
 };
 
 //! Convenience method for loading a SourceFile from \a dataSource. \return SourceFileRef. \see SourceFile::create()
@@ -24,6 +24,8 @@
 #include "cinder/audio2/Voice.h"
 #include "cinder/audio2/Context.h"
 #include "cinder/audio2/NodeEffect.h"
+#include "cinder/audio2/SampleStore.h"
+#include "cinder/audio2/FileOggVorbis.h"
 
 #include <map>
 
@@ -53,6 +55,8 @@ public:
 	void	addVoice( const VoiceRef &source );
 
 	BufferRef loadBuffer( const SourceFileRef &sourceFile, size_t numChannels );
+	//! Returns a SourceFile that decodes \a sourceFile from its encoded bytes kept in memory, or an empty SourceFileRef if it isn't an Ogg Vorbis file on disk.
+	SourceFileRef loadCompressed( const SourceFileRef &sourceFile );
 
 private:
 	MixerImpl();
@@ -65,6 +69,7 @@ private:
 
 	std::vector<Bus> mBusses;
 	std::map<std::pair<SourceFileRef, size_t>, BufferRef> mBufferCache;		// key is [shared_ptr, num channels]
+	SampleStoreRef		mSampleStore;
 
 	GainRef mMasterGain;
 };
@@ -118,6 +123,28 @@ BufferRef MixerImpl::loadBuffer( const SourceFileRef &sourceFile, size_t numChan
 	}
 }
 
+SourceFileRef MixerImpl::loadCompressed( const SourceFileRef &sourceFile )
+{
+	auto oggFile = dynamic_pointer_cast<SourceFileImplOggVorbis>( sourceFile );
+	if( ! oggFile )
+		return SourceFileRef();
+
+	// keyed by file path, so that every Voice playing the same file shares its encoded bytes and decoded blocks. Like mBufferCache,
+	// sounds stay stored for the life of the mixer. Sources without a path (resources, urls) have no stable key and use buffer playback.
+	const DataSourceRef &dataSource = oggFile->getDataSource();
+	if( ! dataSource || ! dataSource->isFilePath() )
+		return SourceFileRef();
+
+	if( ! mSampleStore )
+		mSampleStore = SampleStore::create();
+
+	const string key = dataSource->getFilePath().string();
+	if( ! mSampleStore->contains( key ) )
+		mSampleStore->add( key, dataSource );
+
+	return mSampleStore->createSourceFile( key );
+}
+
 void MixerImpl::setBusVolume( size_t busId, float volume )
 {
 	mBusses[busId].mGain->setValue( volume );
@@ -212,7 +239,15 @@ VoiceSamplePlayer::VoiceSamplePlayer( const SourceFileRef &sourceFile, const Opt
 {
 	sourceFile->setOutputFormat( audio2::master()->getSampleRate(), options.getChannels() );
 
-	if( sourceFile->getNumFrames() <= options.getMaxFramesForBufferPlayback() ) {
+	SourceFileRef compressedFile;
+	if( options.isKeepCompressed() && sourceFile->getNumFrames() <= options.getMaxFramesForBufferPlayback() )
+		compressedFile = MixerImpl::get()->loadCompressed( sourceFile );
+
+	if( compressedFile ) {
+		compressedFile->setOutputFormat( sourceFile->getSampleRate(), sourceFile->getNumChannels() );
+		mNode = Context::master()->makeNode( new FilePlayer( compressedFile ) );
+	}
+	else if( sourceFile->getNumFrames() <= options.getMaxFramesForBufferPlayback() ) {
 		BufferRef buffer = MixerImpl::get()->loadBuffer( sourceFile, options.getChannels() );
 		mNode = Context::master()->makeNode( new BufferPlayer( buffer ) );
 	} else
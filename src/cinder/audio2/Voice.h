@@ -48,19 +48,24 @@ class Voice {
   public:
 	//! Optional parameters passed into Voice::create() methods.
 	struct Options {
-		Options() : mChannels( 0 ), mMaxFramesForBufferPlayback( 96000 ) {}
+		Options() : mChannels( 0 ), mMaxFramesForBufferPlayback( 96000 ), mKeepCompressed( false ) {}
 
 		//! Sets the number of channels for the Voice.
 		Options& channels( size_t ch )							{ mChannels = ch; return *this; }
 		//! Sets the maximum number of frames acceptable for a VoiceSamplePlayer to use in-memory buffer playback via BufferPlayer (default = 96,000).
 		//! If the file is larger than this, it will be streamed from disk using a FilePlayer.
 		Options& maxFramesForBufferPlayback( size_t frames )	{ mMaxFramesForBufferPlayback = frames; return *this; }
+		//! Sets whether Ogg Vorbis files (loaded from a file path) that would use in-memory playback are instead kept encoded in memory and decoded while they play (default = false).
+		//! This uses about a tenth of the memory, at the cost of decoding on a background thread. \see SampleStore
+		Options& keepCompressed( bool b = true )				{ mKeepCompressed = b; return *this; }
 
 		size_t			getChannels() const						{ return mChannels; }
 		size_t			getMaxFramesForBufferPlayback() const	{ return mMaxFramesForBufferPlayback; }
+		bool			isKeepCompressed() const				{ return mKeepCompressed; }
 
 	protected:
 		size_t			mChannels, mMaxFramesForBufferPlayback;
+		bool			mKeepCompressed;
 	};
 
 	//! Creates a Voice that manages sample playback of an audio file pointed at with \a sourceFile.
@@ -479,6 +479,15 @@ void Biquad::setNormalizedCoefficients( double b0, double b1, double b2, double
 	mA2 = a2 * a0Inverse;
 }
 
+void Biquad::getCoefficients( double *b0, double *b1, double *b2, double *a1, double *a2 ) const
+{
+	*b0 = mB0;
+	*b1 = mB1;
+	*b2 = mB2;
+	*a1 = mA1;
+	*a2 = mA2;
+}
+
 
 #if defined( CINDER_AUDIO_VDSP )
 
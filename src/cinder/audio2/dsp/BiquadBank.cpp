@@ -0,0 +1,324 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio2/dsp/BiquadBank.h"
+#include "cinder/audio2/dsp/Biquad.h"
+#include "cinder/audio2/dsp/Dsp.h" // for the SSE intrinsics, <emmintrin.h> also provides _MM_TRANSPOSE4_PS
+#include "cinder/audio2/CinderAssert.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+namespace {
+
+const size_t kNumLanes = BiquadBank::NUM_LANES;
+
+// Each section type holds one group's coefficients and state in registers for the duration of a process call, computing
+// the transposed direct form II recursion: y = b0 * x + s1, s1 = b1 * x - a1 * y + s2, s2 = b2 * x - a2 * y.
+
+#if defined( CINDER_AUDIO_SSE )
+
+struct SectionSse {
+	SectionSse( const float *coeffs, const float *state )
+	{
+		b0 = _mm_loadu_ps( coeffs );
+		b1 = _mm_loadu_ps( coeffs + kNumLanes );
+		b2 = _mm_loadu_ps( coeffs + kNumLanes * 2 );
+		a1 = _mm_loadu_ps( coeffs + kNumLanes * 3 );
+		a2 = _mm_loadu_ps( coeffs + kNumLanes * 4 );
+		s1 = _mm_loadu_ps( state );
+		s2 = _mm_loadu_ps( state + kNumLanes );
+	}
+
+	void storeState( float *state ) const
+	{
+		_mm_storeu_ps( state, s1 );
+		_mm_storeu_ps( state + kNumLanes, s2 );
+	}
+
+	__m128 tick( __m128 x )
+	{
+		__m128 y = _mm_add_ps( _mm_mul_ps( b0, x ), s1 );
+		s1 = _mm_add_ps( _mm_sub_ps( _mm_mul_ps( b1, x ), _mm_mul_ps( a1, y ) ), s2 );
+		s2 = _mm_sub_ps( _mm_mul_ps( b2, x ), _mm_mul_ps( a2, y ) );
+		return y;
+	}
+
+	__m128 b0, b1, b2, a1, a2, s1, s2;
+};
+
+// double precision needs two registers per group, lanes [0, 1] in 'lo' and [2, 3] in 'hi'
+struct SectionSsed {
+	SectionSsed( const double *coeffs, const double *state )
+	{
+		for( size_t i = 0; i < 2; i++ ) {
+			const size_t offset = i * 2;
+			b0[i] = _mm_loadu_pd( coeffs + offset );
+			b1[i] = _mm_loadu_pd( coeffs + kNumLanes + offset );
+			b2[i] = _mm_loadu_pd( coeffs + kNumLanes * 2 + offset );
+			a1[i] = _mm_loadu_pd( coeffs + kNumLanes * 3 + offset );
+			a2[i] = _mm_loadu_pd( coeffs + kNumLanes * 4 + offset );
+			s1[i] = _mm_loadu_pd( state + offset );
+			s2[i] = _mm_loadu_pd( state + kNumLanes + offset );
+		}
+	}
+
+	void storeState( double *state ) const
+	{
+		for( size_t i = 0; i < 2; i++ ) {
+			_mm_storeu_pd( state + i * 2, s1[i] );
+			_mm_storeu_pd( state + kNumLanes + i * 2, s2[i] );
+		}
+	}
+
+	__m128 tick( __m128 x )
+	{
+		__m128d xd[2] = { _mm_cvtps_pd( x ), _mm_cvtps_pd( _mm_movehl_ps( x, x ) ) };
+		__m128d y[2];
+		for( size_t i = 0; i < 2; i++ ) {
+			y[i] = _mm_add_pd( _mm_mul_pd( b0[i], xd[i] ), s1[i] );
+			s1[i] = _mm_add_pd( _mm_sub_pd( _mm_mul_pd( b1[i], xd[i] ), _mm_mul_pd( a1[i], y[i] ) ), s2[i] );
+			s2[i] = _mm_sub_pd( _mm_mul_pd( b2[i], xd[i] ), _mm_mul_pd( a2[i], y[i] ) );
+		}
+
+		return _mm_movelh_ps( _mm_cvtpd_ps( y[0] ), _mm_cvtpd_ps( y[1] ) );
+	}
+
+	__m128d b0[2], b1[2], b2[2], a1[2], a2[2], s1[2], s2[2];
+};
+
+typedef SectionSse	SectionFloat;
+typedef SectionSsed	SectionDouble;
+
+// Frames are loaded four at a time from each lane's channel and transposed, so that each register holds one frame across all lanes.
+template <typename SectionT>
+void processLanes( SectionT &section, const float **sources, float **dests, size_t numActiveLanes, size_t numFrames )
+{
+	size_t i = 0;
+	for( ; i + 4 <= numFrames; i += 4 ) {
+		__m128 frames[4];
+		for( size_t lane = 0; lane < kNumLanes; lane++ )
+			frames[lane] = _mm_loadu_ps( sources[lane] + i );
+
+		_MM_TRANSPOSE4_PS( frames[0], frames[1], frames[2], frames[3] );
+
+		for( size_t f = 0; f < 4; f++ )
+			frames[f] = section.tick( frames[f] );
+
+		_MM_TRANSPOSE4_PS( frames[0], frames[1], frames[2], frames[3] );
+
+		for( size_t lane = 0; lane < numActiveLanes; lane++ )
+			_mm_storeu_ps( dests[lane] + i, frames[lane] );
+	}
+
+	for( ; i < numFrames; i++ ) {
+		__m128 y = section.tick( _mm_setr_ps( sources[0][i], sources[1][i], sources[2][i], sources[3][i] ) );
+
+		float out[kNumLanes];
+		_mm_storeu_ps( out, y );
+		for( size_t lane = 0; lane < numActiveLanes; lane++ )
+			dests[lane][i] = out[lane];
+	}
+}
+
+#else
+
+template <typename T>
+struct SectionScalar {
+	SectionScalar( const T *coeffs, const T *state )
+	{
+		for( size_t lane = 0; lane < kNumLanes; lane++ ) {
+			b0[lane] = coeffs[lane];
+			b1[lane] = coeffs[kNumLanes + lane];
+			b2[lane] = coeffs[kNumLanes * 2 + lane];
+			a1[lane] = coeffs[kNumLanes * 3 + lane];
+			a2[lane] = coeffs[kNumLanes * 4 + lane];
+			s1[lane] = state[lane];
+			s2[lane] = state[kNumLanes + lane];
+		}
+	}
+
+	void storeState( T *state ) const
+	{
+		for( size_t lane = 0; lane < kNumLanes; lane++ ) {
+			state[lane] = s1[lane];
+			state[kNumLanes + lane] = s2[lane];
+		}
+	}
+
+	void tick( const T *x, T *y )
+	{
+		for( size_t lane = 0; lane < kNumLanes; lane++ ) {
+			y[lane] = b0[lane] * x[lane] + s1[lane];
+			s1[lane] = b1[lane] * x[lane] - a1[lane] * y[lane] + s2[lane];
+			s2[lane] = b2[lane] * x[lane] - a2[lane] * y[lane];
+		}
+	}
+
+	T b0[kNumLanes], b1[kNumLanes], b2[kNumLanes], a1[kNumLanes], a2[kNumLanes], s1[kNumLanes], s2[kNumLanes];
+};
+
+typedef SectionScalar<float>	SectionFloat;
+typedef SectionScalar<double>	SectionDouble;
+
+template <typename T>
+void processLanes( SectionScalar<T> &section, const float **sources, float **dests, size_t numActiveLanes, size_t numFrames )
+{
+	T x[kNumLanes], y[kNumLanes];
+	for( size_t i = 0; i < numFrames; i++ ) {
+		for( size_t lane = 0; lane < kNumLanes; lane++ )
+			x[lane] = sources[lane][i];
+
+		section.tick( x, y );
+
+		for( size_t lane = 0; lane < numActiveLanes; lane++ )
+			dests[lane][i] = (float)y[lane];
+	}
+}
+
+#endif // defined( CINDER_AUDIO_SSE )
+
+} // anonymous namespace
+
+BiquadBank::BiquadBank( size_t numFilters, Precision precision )
+	: mNumFilters( 0 ), mPrecision( precision )
+{
+	setNumFilters( numFilters );
+}
+
+void BiquadBank::setNumFilters( size_t numFilters )
+{
+	mNumFilters = numFilters;
+
+	const size_t numGroups = getNumGroups();
+	mCoeffs.assign( numGroups * NUM_COEFFS * kNumLanes, 0 );
+	mCoeffsd.assign( numGroups * NUM_COEFFS * kNumLanes, 0 );
+	mState.assign( numGroups * NUM_STATES * kNumLanes, 0 );
+	mStated.assign( numGroups * NUM_STATES * kNumLanes, 0 );
+
+	// initialize as pass-thru, unused lanes in the last group are left at zero so they output silence.
+	for( size_t filter = 0; filter < mNumFilters; filter++ )
+		setCoefficients( filter, 1, 0, 0, 0, 0 );
+}
+
+void BiquadBank::setPrecision( Precision precision )
+{
+	if( mPrecision == precision )
+		return;
+
+	mPrecision = precision;
+	reset();
+}
+
+void BiquadBank::setCoefficients( size_t filter, double b0, double b1, double b2, double a1, double a2 )
+{
+	CI_ASSERT( filter < mNumFilters );
+
+	const size_t offset = ( filter / kNumLanes ) * NUM_COEFFS * kNumLanes + filter % kNumLanes;
+	const double coeffs[NUM_COEFFS] = { b0, b1, b2, a1, a2 };
+	for( size_t i = 0; i < NUM_COEFFS; i++ ) {
+		mCoeffsd[offset + i * kNumLanes] = coeffs[i];
+		mCoeffs[offset + i * kNumLanes] = (float)coeffs[i];
+	}
+}
+
+void BiquadBank::setCoefficients( size_t filter, const Biquad &biquad )
+{
+	double b0, b1, b2, a1, a2;
+	biquad.getCoefficients( &b0, &b1, &b2, &a1, &a2 );
+	setCoefficients( filter, b0, b1, b2, a1, a2 );
+}
+
+void BiquadBank::process( const float *const *sources, float *const *dests, size_t numFrames )
+{
+	const size_t numGroups = getNumGroups();
+	for( size_t group = 0; group < numGroups; group++ ) {
+		const size_t firstFilter = group * kNumLanes;
+		const size_t numActiveLanes = min( kNumLanes, mNumFilters - firstFilter );
+
+		// unused lanes read from the first lane's source (their coefficients are zero) and are never written.
+		const float *groupSources[kNumLanes];
+		float *groupDests[kNumLanes];
+		for( size_t lane = 0; lane < kNumLanes; lane++ ) {
+			const bool active = lane < numActiveLanes;
+			groupSources[lane] = sources[active ? firstFilter + lane : firstFilter];
+			groupDests[lane] = active ? dests[firstFilter + lane] : nullptr;
+		}
+
+		if( mPrecision == FLOAT )
+			processGroupFloat( group, groupSources, groupDests, numActiveLanes, numFrames );
+		else
+			processGroupDouble( group, groupSources, groupDests, numActiveLanes, numFrames );
+	}
+}
+
+void BiquadBank::process( Buffer *buffer )
+{
+	CI_ASSERT( buffer->getNumChannels() == mNumFilters );
+
+	float *channels[kNumLanes];
+	const size_t numFrames = buffer->getNumFrames();
+
+	// processed a group at a time so the channel pointer arrays can live on the stack.
+	for( size_t firstFilter = 0; firstFilter < mNumFilters; firstFilter += kNumLanes ) {
+		const size_t numActiveLanes = min( kNumLanes, mNumFilters - firstFilter );
+		for( size_t lane = 0; lane < kNumLanes; lane++ )
+			channels[lane] = buffer->getChannel( firstFilter + ( lane < numActiveLanes ? lane : 0 ) );
+
+		const size_t group = firstFilter / kNumLanes;
+		const float *sources[kNumLanes] = { channels[0], channels[1], channels[2], channels[3] };
+		if( mPrecision == FLOAT )
+			processGroupFloat( group, sources, channels, numActiveLanes, numFrames );
+		else
+			processGroupDouble( group, sources, channels, numActiveLanes, numFrames );
+	}
+}
+
+void BiquadBank::reset()
+{
+	fill( mState.begin(), mState.end(), 0.0f );
+	fill( mStated.begin(), mStated.end(), 0.0 );
+}
+
+void BiquadBank::processGroupFloat( size_t group, const float **sources, float **dests, size_t numActiveLanes, size_t numFrames )
+{
+	float *state = &mState[group * NUM_STATES * kNumLanes];
+
+	SectionFloat section( &mCoeffs[group * NUM_COEFFS * kNumLanes], state );
+	processLanes( section, sources, dests, numActiveLanes, numFrames );
+	section.storeState( state );
+}
+
+void BiquadBank::processGroupDouble( size_t group, const float **sources, float **dests, size_t numActiveLanes, size_t numFrames )
+{
+	double *state = &mStated[group * NUM_STATES * kNumLanes];
+
+	SectionDouble section( &mCoeffsd[group * NUM_COEFFS * kNumLanes], state );
+	processLanes( section, sources, dests, numActiveLanes, numFrames );
+	section.storeState( state );
+}
+
+} } } // namespace cinder::audio2::dsp
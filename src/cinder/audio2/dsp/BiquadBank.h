@@ -0,0 +1,88 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio2/Buffer.h"
+
+#include <vector>
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+class Biquad;
+
+//! \brief Processes many independent biquad filters simultaneously.
+//!
+//! Coefficients and state are stored in structure-of-arrays layout, in groups of NUM_LANES filters, and each group's recursion is computed
+//! together in SIMD registers (SSE2 when available, otherwise a lane loop suitable for auto-vectorization). Filter state is kept either in
+//! float or, for filters with low cutoff frequencies where rounding noise becomes audible, in double precision. Each filter is a transposed
+//! direct form II section. All memory is allocated by setNumFilters(), process() is safe to call on the audio thread.
+class BiquadBank {
+  public:
+	//! Precision of the filter state and arithmetic. Samples are always read and written as float.
+	enum Precision { FLOAT, DOUBLE };
+
+	//! Number of filters processed together.
+	static const size_t NUM_LANES = 4;
+
+	BiquadBank( size_t numFilters = 0, Precision precision = FLOAT );
+
+	//! Sets the number of filters in the bank. All filters are reset to pass-thru.
+	void		setNumFilters( size_t numFilters );
+	//! Returns the number of filters in the bank.
+	size_t		getNumFilters() const			{ return mNumFilters; }
+	//! Sets the precision of the filter state. Existing state is cleared, but coefficients are kept. Does not allocate.
+	void		setPrecision( Precision precision );
+	//! Returns the precision of the filter state.
+	Precision	getPrecision() const			{ return mPrecision; }
+
+	//! Sets the normalized coefficients of filter \a filter, where y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] - a1 * y[n-1] - a2 * y[n-2].
+	void	setCoefficients( size_t filter, double b0, double b1, double b2, double a1, double a2 );
+	//! Sets the coefficients of filter \a filter to those currently designed by \a biquad.
+	void	setCoefficients( size_t filter, const Biquad &biquad );
+
+	//! Filters \a numFrames samples of \a sources[i] with filter i, writing the output to \a dests[i], for every filter in the bank. Sources may equal dests (in-place).
+	void	process( const float *const *sources, float *const *dests, size_t numFrames );
+	//! Filters each channel of \a buffer in-place with the filter of the same index. \a buffer must have getNumFilters() channels.
+	void	process( Buffer *buffer );
+
+	//! Clears the state of all filters.
+	void	reset();
+
+  private:
+	enum Coeff { B0, B1, B2, A1, A2, NUM_COEFFS };
+	enum State { S1, S2, NUM_STATES };
+
+	size_t	getNumGroups() const	{ return ( mNumFilters + NUM_LANES - 1 ) / NUM_LANES; }
+
+	void	processGroupFloat( size_t group, const float **sources, float **dests, size_t numActiveLanes, size_t numFrames );
+	void	processGroupDouble( size_t group, const float **sources, float **dests, size_t numActiveLanes, size_t numFrames );
+
+	size_t				mNumFilters;
+	Precision			mPrecision;
+	// per group: NUM_COEFFS (or NUM_STATES) rows of NUM_LANES values
+	std::vector<float>	mCoeffs, mState;
+	std::vector<double>	mCoeffsd, mStated;
+};
+
+} } } // namespace cinder::audio2::dsp
@@ -25,12 +25,39 @@
 
 #include "cinder/CinderMath.h"
 
+#include <algorithm>
+
 #if defined( CINDER_AUDIO_VDSP )
 	#include <Accelerate/Accelerate.h>
 #endif
 
 using namespace ci;
 
+namespace {
+
+// number of samples computed by recurrence before a ramp is resynced to its exact value
+const size_t RAMP_RESYNC_INTERVAL = 64;
+
+// conversions between phase in cycles and 32-bit fixed point, where 2^32 is one cycle
+inline uint32_t toFixedPhase( float phase )
+{
+	return uint32_t( int64_t( double( phase - std::floor( phase ) ) * 4294967296.0 ) );
+}
+
+// increments are first wrapped to [-1/2:1/2] cycles, which doesn't change the resulting phases
+inline uint32_t toFixedPhaseIncr( float phaseIncr )
+{
+	return uint32_t( int64_t( double( phaseIncr - std::floor( phaseIncr + 0.5f ) ) * 4294967296.0 ) );
+}
+
+// only the upper 24 bits fit in a float's mantissa, truncating keeps the result below 1
+inline float fromFixedPhase( uint32_t phase )
+{
+	return float( phase >> 8 ) * ( 1.0f / 16777216.0f );
+}
+
+} // anonymous namespace
+
 namespace cinder { namespace audio2 { namespace dsp {
 
 #if defined( CINDER_AUDIO_VDSP )
@@ -105,6 +132,11 @@ void addMul( const float *arrayA, const float *arrayB, float scalar, float *resu
 	vDSP_vasm( const_cast<float *>( arrayA ), 1, const_cast<float *>( arrayB ), 1, &scalar, result, 1, length );
 }
 
+void mulAdd( const float *array, float scalarMul, float scalarAdd, float *result, size_t length )
+{
+	vDSP_vsmsa( const_cast<float *>( array ), 1, &scalarMul, &scalarAdd, result, 1, length );
+}
+
 #else // ! defined( CINDER_AUDIO_VDSP )
 
 // from WebKit's applyWindow in RealtimeAnalyser.cpp
@@ -199,6 +231,12 @@ void addMul( const float *arrayA, const float *arrayB, float scalar, float *resu
 		result[i] = ( arrayA[i] + arrayB[i] ) * scalar;
 }
 
+void mulAdd( const float *array, float scalarMul, float scalarAdd, float *result, size_t length )
+{
+	for( size_t i = 0; i < length; i++ )
+		result[i] = array[i] * scalarMul + scalarAdd;
+}
+
 #endif // ! defined( CINDER_AUDIO_VDSP )
 
 
@@ -239,4 +277,123 @@ void normalize( float *array, size_t length, float maxValue )
 	}
 }
 
+// Both ramps are computed in chunks of RAMP_RESYNC_INTERVAL samples. The first value of each chunk is computed exactly in double precision,
+// the rest by adding (or multiplying by) the increment, four lanes at a time when SSE is available.
+
+void ramp( float *array, size_t length, float begin, float incr )
+{
+#if defined( CINDER_AUDIO_VDSP )
+	// vDSP_vramp computes each element as begin + i * incr, so there is no error to accumulate
+	vDSP_vramp( &begin, &incr, array, 1, length );
+#else
+	for( size_t chunk = 0; chunk < length; chunk += RAMP_RESYNC_INTERVAL ) {
+		const size_t chunkLength = std::min( RAMP_RESYNC_INTERVAL, length - chunk );
+		const float chunkBegin = float( double( begin ) + double( chunk ) * double( incr ) );
+		float *chunkArray = array + chunk;
+		size_t i = 0;
+
+	#if defined( CINDER_AUDIO_SSE )
+		__m128 value = _mm_add_ps( _mm_set1_ps( chunkBegin ), _mm_mul_ps( _mm_set_ps( 3, 2, 1, 0 ), _mm_set1_ps( incr ) ) );
+		const __m128 incr4 = _mm_set1_ps( incr * 4 );
+		for( ; i + 4 <= chunkLength; i += 4 ) {
+			_mm_storeu_ps( chunkArray + i, value );
+			value = _mm_add_ps( value, incr4 );
+		}
+	#endif
+
+		float value1 = chunkBegin + float( i ) * incr;
+		for( ; i < chunkLength; i++ ) {
+			chunkArray[i] = value1;
+			value1 += incr;
+		}
+	}
+#endif
+}
+
+void rampGeometric( float *array, size_t length, float begin, float ratio )
+{
+	for( size_t chunk = 0; chunk < length; chunk += RAMP_RESYNC_INTERVAL ) {
+		const size_t chunkLength = std::min( RAMP_RESYNC_INTERVAL, length - chunk );
+		const float chunkBegin = float( double( begin ) * std::pow( double( ratio ), double( chunk ) ) );
+		float *chunkArray = array + chunk;
+		size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+		const float ratio2 = ratio * ratio;
+		__m128 value = _mm_mul_ps( _mm_set1_ps( chunkBegin ), _mm_set_ps( ratio2 * ratio, ratio2, ratio, 1 ) );
+		const __m128 ratio4 = _mm_set1_ps( ratio2 * ratio2 );
+		for( ; i + 4 <= chunkLength; i += 4 ) {
+			_mm_storeu_ps( chunkArray + i, value );
+			value = _mm_mul_ps( value, ratio4 );
+		}
+#endif
+
+		float value1 = float( double( chunkBegin ) * std::pow( double( ratio ), double( i ) ) );
+		for( ; i < chunkLength; i++ ) {
+			chunkArray[i] = value1;
+			value1 *= ratio;
+		}
+	}
+}
+
+// The phase of each sample is computed in fixed point and then passed to sinFixedPhase(), four samples at a time when SSE is available.
+// With a varying increment, the four phases are the running (prefix) sum of the increments.
+
+float sine( float *array, size_t length, float phase, float phaseIncr )
+{
+	uint32_t phaseFixed = toFixedPhase( phase );
+	const uint32_t incr = toFixedPhaseIncr( phaseIncr );
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	__m128i phase4 = _mm_add_epi32( _mm_set1_epi32( int32_t( phaseFixed ) ), _mm_set_epi32( int32_t( incr * 3 ), int32_t( incr * 2 ), int32_t( incr ), 0 ) );
+	const __m128i incr4 = _mm_set1_epi32( int32_t( incr * 4 ) );
+	for( ; i + 4 <= length; i += 4 ) {
+		_mm_storeu_ps( array + i, sinFixedPhase( phase4 ) );
+		phase4 = _mm_add_epi32( phase4, incr4 );
+	}
+
+	phaseFixed += incr * uint32_t( i );
+#endif
+
+	for( ; i < length; i++ ) {
+		array[i] = sinFixedPhase( phaseFixed );
+		phaseFixed += incr;
+	}
+
+	return fromFixedPhase( phaseFixed );
+}
+
+float sine( float *array, size_t length, float phase, const float *phaseIncrArray )
+{
+	uint32_t phaseFixed = toFixedPhase( phase );
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	__m128i phase4 = _mm_set1_epi32( int32_t( phaseFixed ) );
+	for( ; i + 4 <= length; i += 4 ) {
+		// wrap to [-1/2:1/2] cycles so the fixed point increments fit in 32 bits, exactly 1/2 overflows to -1/2, which is the same phase
+		__m128 incr = _mm_loadu_ps( phaseIncrArray + i );
+		incr = _mm_sub_ps( incr, _mm_cvtepi32_ps( _mm_cvtps_epi32( incr ) ) );
+		const __m128i incrFixed = _mm_cvtps_epi32( _mm_mul_ps( incr, _mm_set1_ps( 4294967296.0f ) ) );
+
+		__m128i incrSum = _mm_add_epi32( incrFixed, _mm_slli_si128( incrFixed, 4 ) );
+		incrSum = _mm_add_epi32( incrSum, _mm_slli_si128( incrSum, 8 ) );
+
+		_mm_storeu_ps( array + i, sinFixedPhase( _mm_add_epi32( phase4, _mm_sub_epi32( incrSum, incrFixed ) ) ) );
+		phase4 = _mm_add_epi32( phase4, _mm_shuffle_epi32( incrSum, 0xFF ) );
+	}
+
+	phaseFixed = uint32_t( _mm_cvtsi128_si32( phase4 ) );
+#endif
+
+	for( ; i < length; i++ ) {
+		const uint32_t incr = toFixedPhaseIncr( phaseIncrArray[i] );
+		array[i] = sinFixedPhase( phaseFixed );
+		phaseFixed += incr;
+	}
+
+	return fromFixedPhase( phaseFixed );
+}
+
 } } } // namespace cinder::audio2::dsp
\ No newline at end of file
@@ -31,9 +31,19 @@
 	#define CINDER_AUDIO_VDSP
 #endif
 
+// SSE2 paths are used where vDSP has no equivalent routine, so this is defined independently of CINDER_AUDIO_VDSP.
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+	#define CINDER_AUDIO_SSE
+#endif
+
+#if defined( CINDER_AUDIO_SSE )
+	#include <emmintrin.h>
+#endif
+
 #include <atomic>
 #include <vector>
 #include <cmath>
+#include <cstdint>
 
 namespace cinder { namespace audio2 { namespace dsp {
 
@@ -69,6 +79,8 @@ void mul( const float *array, float scalar, float *result, size_t length );
 void mul( const float *arrayA, const float *arrayB, float *result, size_t length );
 //! sums \a length elements of \a arrayA by \a arrayB (element-wise), then scales by \a scalar and leaves the result at \a result.
 void addMul( const float *arrayA, const float *arrayB, float scalar, float *result, size_t length );
+//! multiplies \a length elements of \a array by \a scalarMul, then adds \a scalarAdd and leaves the result at \a result.
+void mulAdd( const float *array, float scalarMul, float scalarAdd, float *result, size_t length );
 //! divides \a length elements of \a array by \a scalar and leaves the result at \a result.
 void divide( const float *array, float scalar, float *result, size_t length );
 //! returns the sum of \a array
@@ -78,4 +90,50 @@ float rms( const float *array, size_t length );
 //! normalizes \a array to \a maxValue (default = 1)
 void normalize( float *array, size_t length, float maxValue = 1 );
 
+//! fills \a array with a linear ramp, \code array[i] = begin + i * incr \endcode. Values are resynced periodically so error doesn't accumulate over long ramps.
+void ramp( float *array, size_t length, float begin, float incr );
+//! fills \a array with a geometric (exponential) ramp, \code array[i] = begin * ratio^i \endcode. Values are resynced periodically so error doesn't accumulate over long ramps.
+void rampGeometric( float *array, size_t length, float begin, float ratio );
+
+//! fills \a array with a sine wave, \code array[i] = sin( 2 * pi * ( phase + i * phaseIncr ) ) \endcode, where \a phase and \a phaseIncr are in cycles.
+//! Returns the phase following the last sample, wrapped to [0:1). The phase is accumulated in 32-bit fixed point, max error is 3e-7. \see sinFixedPhase()
+float sine( float *array, size_t length, float phase, float phaseIncr );
+//! fills \a array with a sine wave whose phase increases by \a phaseIncrArray[i] after each sample, otherwise the same as the constant increment variant.
+//! \a phaseIncrArray may be the same as \a array, each increment is read before its sample is written.
+float sine( float *array, size_t length, float phase, const float *phaseIncrArray );
+
+//! Returns sin( 2 * pi * phase ), where \a phase is 32-bit fixed point with 2^32 as one cycle. The phase is folded into [-1/4:1/4] cycles and
+//! evaluated with an odd, degree 9 minimax polynomial. The polynomial's error is 3.4e-9, in practice float rounding limits the max error to 3e-7.
+inline float sinFixedPhase( uint32_t phase )
+{
+	const float y = float( int32_t( phase ) ) * ( 1.0f / 2147483648.0f ); // sin( pi * y ), y in [-1:1)
+	const float a = std::fabs( y );
+	const float t = ( a < 0.5f ? a : 1.0f - a ) * ( y < 0 ? -1.0f : 1.0f );
+	const float t2 = t * t;
+
+	return t * ( 3.14159258f + t2 * ( -5.16770688f + t2 * ( 2.55003138f + t2 * ( -0.598045174f + t2 * 0.077220129f ) ) ) );
+}
+
+#if defined( CINDER_AUDIO_SSE )
+
+//! Four lane variant of sinFixedPhase( uint32_t ).
+inline __m128 sinFixedPhase( __m128i phase )
+{
+	const __m128 signMask = _mm_castsi128_ps( _mm_set1_epi32( 0x80000000 ) );
+
+	const __m128 y = _mm_mul_ps( _mm_cvtepi32_ps( phase ), _mm_set1_ps( 1.0f / 2147483648.0f ) );
+	const __m128 a = _mm_andnot_ps( signMask, y );
+	const __m128 t = _mm_or_ps( _mm_min_ps( a, _mm_sub_ps( _mm_set1_ps( 1.0f ), a ) ), _mm_and_ps( signMask, y ) );
+	const __m128 t2 = _mm_mul_ps( t, t );
+
+	__m128 result = _mm_add_ps( _mm_set1_ps( -0.598045174f ), _mm_mul_ps( t2, _mm_set1_ps( 0.077220129f ) ) );
+	result = _mm_add_ps( _mm_set1_ps( 2.55003138f ), _mm_mul_ps( t2, result ) );
+	result = _mm_add_ps( _mm_set1_ps( -5.16770688f ), _mm_mul_ps( t2, result ) );
+	result = _mm_add_ps( _mm_set1_ps( 3.14159258f ), _mm_mul_ps( t2, result ) );
+
+	return _mm_mul_ps( t, result );
+}
+
+#endif // defined( CINDER_AUDIO_SSE )
+
 } } } // namespace cinder::audio2::dsp
\ No newline at end of file
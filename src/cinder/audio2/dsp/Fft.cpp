@@ -134,7 +134,8 @@ void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
 	CI_ASSERT( waveform->getNumFrames() == mSize );
 	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
 
-	mBufferCopy.copy( *spectral );
+	// spectral is stored as two channels of mSizeOverTwo frames (real, then imag), copy both into the single channel mBufferCopy.
+	memcpy( mBufferCopy.getData(), spectral->getData(), mSize * sizeof( float ) );
 
 	float *real = mBufferCopy.getData();
 	float *imag = &mBufferCopy.getData()[mSizeOverTwo];
@@ -23,9 +23,12 @@
 
 #pragma once
 
+#include "cinder/audio2/Buffer.h"
 #include "cinder/audio2/CinderAssert.h"
 
 #include <atomic>
+#include <mutex>
+#include <vector>
 
 namespace cinder { namespace audio2 { namespace dsp {
 
@@ -151,6 +154,12 @@ public:
 		mReadIndex.store( readIndexAfter, std::memory_order_release );
 		return true;
 	}
+	//! Discards all elements currently available for reading.
+	//! \note only safe to call from the read thread.
+	void clear()
+	{
+		mReadIndex.store( mWriteIndex.load( std::memory_order_acquire ), std::memory_order_release );
+	}
 
 private:
 	size_t getAvailableWrite( size_t writeIndex, size_t readIndex ) const
@@ -179,5 +188,185 @@ private:
 
 typedef RingBufferT<float> RingBuffer;
 
+//! Multichannel version of RingBufferT with planar storage, where all channels share a single pair of read / write indices.
+//! Frames are always written and read for every channel at once, so channels can't drift apart, and each block costs one
+//! acquire / release pair no matter how many channels there are.
+//!
+//! The implementation remains lock-free and thread-safe within a single write thread / single read thread context.
+//!
+//! \note \a T must be POD.
+template <typename T>
+class MultiChannelRingBufferT {
+public:
+	//! Constructs a MultiChannelRingBufferT with size = 0
+	MultiChannelRingBufferT() : mAllocatedSize( 0 ), mNumChannels( 0 ), mWriteIndex( 0 ), mReadIndex( 0 ) {}
+	//! Constructs a MultiChannelRingBufferT with \a numFrames maximum frames of \a numChannels channels.
+	MultiChannelRingBufferT( size_t numFrames, size_t numChannels ) : mWriteIndex( 0 ), mReadIndex( 0 )
+	{
+		resize( numFrames, numChannels );
+	}
+
+	//! Resizes the container to contain \a numFrames maximum frames of \a numChannels channels. Invalidates the internal buffer and resets read / write indices to 0.
+	void resize( size_t numFrames, size_t numChannels )
+	{
+		mAllocatedSize = numFrames + 1; // one frame is used to distinguish between the read and write indices when full.
+		mNumChannels = numChannels;
+		mData.assign( mAllocatedSize * mNumChannels, T() );
+
+		mWriteIndex = 0;
+		mReadIndex = 0;
+	}
+	//! Returns the maximum number of frames.
+	size_t getSize() const
+	{
+		return mAllocatedSize ? mAllocatedSize - 1 : 0;
+	}
+	//! Returns the number of channels.
+	size_t getNumChannels() const
+	{
+		return mNumChannels;
+	}
+	//! Returns the number of frames available for writing. \note Only safe to call from the write thread.
+	size_t getAvailableWrite() const
+	{
+		return getAvailableWrite( mWriteIndex, mReadIndex );
+	}
+	//! Returns the number of frames available for reading. \note Only safe to call from the read thread.
+	size_t getAvailableRead() const
+	{
+		return getAvailableRead( mWriteIndex, mReadIndex );
+	}
+	//! Writes \a numFrames frames of every channel from \a buffer, starting at \a bufferFrameOffset. Returns \c true if all frames were written,
+	//! or false (writing nothing) if there isn't enough space. \note only safe to call from the write thread.
+	bool write( const BufferT<T> &buffer, size_t numFrames, size_t bufferFrameOffset = 0 )
+	{
+		CI_ASSERT( buffer.getNumChannels() == mNumChannels );
+		CI_ASSERT( bufferFrameOffset + numFrames <= buffer.getNumFrames() );
+
+		const size_t writeIndex = mWriteIndex.load( std::memory_order_relaxed );
+		const size_t readIndex = mReadIndex.load( std::memory_order_acquire );
+
+		if( numFrames > getAvailableWrite( writeIndex, readIndex ) )
+			return false;
+
+		const size_t countA = std::min( numFrames, mAllocatedSize - writeIndex );
+		const size_t countB = numFrames - countA;
+
+		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+			const T *source = buffer.getChannel( ch ) + bufferFrameOffset;
+			T *channel = &mData[ch * mAllocatedSize];
+
+			std::memcpy( channel + writeIndex, source, countA * sizeof( T ) );
+			if( countB )
+				std::memcpy( channel, source + countA, countB * sizeof( T ) );
+		}
+
+		size_t writeIndexAfter = writeIndex + numFrames;
+		if( writeIndexAfter >= mAllocatedSize )
+			writeIndexAfter -= mAllocatedSize;
+
+		mWriteIndex.store( writeIndexAfter, std::memory_order_release );
+		return true;
+	}
+	//! Reads \a numFrames frames of every channel into \a buffer, starting at \a bufferFrameOffset. Returns \c true if all frames were read,
+	//! or false (reading nothing) if not enough are available. \note only safe to call from the read thread.
+	bool read( BufferT<T> *buffer, size_t numFrames, size_t bufferFrameOffset = 0 )
+	{
+		CI_ASSERT( buffer->getNumChannels() == mNumChannels );
+		CI_ASSERT( bufferFrameOffset + numFrames <= buffer->getNumFrames() );
+
+		const size_t writeIndex = mWriteIndex.load( std::memory_order_acquire );
+		const size_t readIndex = mReadIndex.load( std::memory_order_relaxed );
+
+		if( numFrames > getAvailableRead( writeIndex, readIndex ) )
+			return false;
+
+		const size_t countA = std::min( numFrames, mAllocatedSize - readIndex );
+		const size_t countB = numFrames - countA;
+
+		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+			T *dest = buffer->getChannel( ch ) + bufferFrameOffset;
+			const T *channel = &mData[ch * mAllocatedSize];
+
+			std::memcpy( dest, channel + readIndex, countA * sizeof( T ) );
+			if( countB )
+				std::memcpy( dest + countA, channel, countB * sizeof( T ) );
+		}
+
+		size_t readIndexAfter = readIndex + numFrames;
+		if( readIndexAfter >= mAllocatedSize )
+			readIndexAfter -= mAllocatedSize;
+
+		mReadIndex.store( readIndexAfter, std::memory_order_release );
+		return true;
+	}
+	//! Discards all frames currently available for reading.
+	//! \note only safe to call from the read thread.
+	void clear()
+	{
+		mReadIndex.store( mWriteIndex.load( std::memory_order_acquire ), std::memory_order_release );
+	}
+
+private:
+	size_t getAvailableWrite( size_t writeIndex, size_t readIndex ) const
+	{
+		size_t result = readIndex - writeIndex - 1;
+		if( writeIndex >= readIndex )
+			result += mAllocatedSize;
+
+		return result;
+	}
+
+	size_t getAvailableRead( size_t writeIndex, size_t readIndex ) const
+	{
+		if( writeIndex >= readIndex )
+			return writeIndex - readIndex;
+
+		return writeIndex + mAllocatedSize - readIndex;
+	}
+
+	std::vector<T>			mData;
+	size_t					mAllocatedSize, mNumChannels;
+	std::atomic<size_t>		mWriteIndex, mReadIndex;
+};
+
+typedef MultiChannelRingBufferT<float> MultiChannelRingBuffer;
+
+//! Queue of commands sent from user threads to a Node's process() method, built on RingBufferT. Producers must be serialized by the
+//! caller (typically with a mutex that the audio thread never takes), and only the audio thread reads.
+//!
+//! If the queue is full when pushing, the audio thread isn't draining it, most likely because the Context is disabled. In that case push()
+//! takes \a consumerMutex, the Context's mutex, which guarantees that process() isn't running, so it is safe to become the consumer and
+//! drain the queue with \a drainFn before writing the command.
+//!
+//! \note \a T must be POD.
+template <typename T>
+class CommandQueueT {
+public:
+	//! Constructs a CommandQueueT that holds up to \a count commands.
+	CommandQueueT( size_t count ) : mRingBuffer( count ) {}
+
+	//! Pushes \a command, draining the queue with \a drainFn while holding \a consumerMutex if it is full.
+	template <typename DrainFnT>
+	void push( const T &command, std::mutex &consumerMutex, DrainFnT drainFn )
+	{
+		if( mRingBuffer.write( &command, 1 ) )
+			return;
+
+		std::lock_guard<std::mutex> lock( consumerMutex );
+		drainFn();
+
+		CI_VERIFY( mRingBuffer.write( &command, 1 ) );
+	}
+
+	//! Reads the oldest command into \a command, returns false if the queue is empty. Only the consumer may call this.
+	bool pop( T *command )				{ return mRingBuffer.read( command, 1 ); }
+	//! Returns the number of commands waiting to be read.
+	size_t getAvailableRead() const		{ return mRingBuffer.getAvailableRead(); }
+
+private:
+	RingBufferT<T>	mRingBuffer;
+};
+
 
 } } } // namespace cinder::audio2::dsp
@@ -23,12 +23,17 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include "cinder/audio2/dsp/WaveTable.h"
 #include "cinder/audio2/dsp/Dsp.h"
+#include "cinder/audio2/dsp/Fft.h"
 #include "cinder/audio2/Utilities.h"
 #include "cinder/audio2/Debug.h"
 #include "cinder/CinderMath.h"
 
 #include "cinder/Timer.h" // TEMP
 
+#include <map>
+#include <mutex>
+#include <cstdint>
+
 using namespace std;
 
 namespace {
@@ -43,6 +48,17 @@ inline float calcGibbsReduceCoeff( size_t partial, size_t numPartials )
 	return result * result;
 }
 
+// Imaginary bin value that the inverse Fft turns into a unit amplitude sine, per table length. vDSP's forward transform is scaled by two
+// and uses the opposite sign convention compared to ooura.
+inline float calcSineBinScale( size_t length )
+{
+#if defined( CINDER_AUDIO_FFT_OOURA )
+	return float( length ) / 2.0f;
+#else
+	return - float( length );
+#endif
+}
+
 inline float calcTableIndex( float f0Midi, float minRange, float maxRange, size_t numTables )
 {
 	const float midiRangePerTable = ( maxRange - minRange ) / ( numTables - 1 );
@@ -70,7 +86,7 @@ inline float tableLookup( const float *table, size_t tableSize, float phase )
 	float val2 = table[index2];
 	float frac = lookup - (float)index1;
 
-	return val2 + frac * ( val2 - val1 );
+	return val1 + frac * ( val2 - val1 );
 }
 
 #endif
@@ -79,16 +95,254 @@ inline float tableLookup( const float *table, size_t tableSize, float phase )
 
 namespace cinder { namespace audio2 { namespace dsp {
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Fixed-point lookup kernels
+// ----------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Lookup phase is accumulated in 32-bit fixed point, where 2^32 is one cycle. It wraps by integer overflow so no floor() is needed, and for a
+// power of two table size the upper bits are the table index while the lower bits are the interpolation fraction.
+const double kFixedPhaseScale = 4294967296.0;
+
+// midi = 12 * log2( freq ) + kMidiOffset, matching toMidi()
+const float kMidiOffset = 17.3123405046f * log( .12231220585f );
+
+inline uint32_t toFixedPhase( float phase )
+{
+	return uint32_t( uint64_t( double( wrap( phase ) ) * kFixedPhaseScale ) );
+}
+
+inline float fromFixedPhase( uint32_t phase )
+{
+	return float( double( phase ) / kFixedPhaseScale );
+}
+
+//! converts an increment of \a cycles per sample, any whole cycles are discarded.
+inline uint32_t toFixedIncr( double cycles )
+{
+	return uint32_t( uint64_t( ( cycles - floor( cycles ) ) * kFixedPhaseScale ) );
+}
+
+// log2 from the float's exponent plus a cubic fit over its mantissa, max error is 0.0013 (octaves).
+inline float fastLog2( float x )
+{
+	union { float f; uint32_t i; } bits;
+	bits.f = x;
+	const float exponent = float( int32_t( ( bits.i >> 23 ) & 0xFF ) - 127 );
+	bits.i = ( bits.i & 0x007FFFFF ) | 0x3F800000;
+	const float m = bits.f;
+
+	return exponent + ( -2.1338866f + m * ( 3.0108510f + m * ( -1.0295584f + m * 0.15392465f ) ) );
+}
+
+struct FixedTable {
+	FixedTable( const float *data, size_t tableSize )
+		: mData( data ), mLog2Size( 0 ), mIndexMask( uint32_t( tableSize - 1 ) )
+	{
+		CI_ASSERT_MSG( tableSize >= 2 && isPowerOf2( tableSize ), "table size must be a power of two" );
+
+		while( ( size_t( 1 ) << mLog2Size ) < tableSize )
+			mLog2Size++;
+
+		mShift = 32 - mLog2Size;
+		mFracMask = ( 1u << mShift ) - 1;
+		mFracScale = float( 1.0 / double( uint64_t( 1 ) << mShift ) );
+	}
+
+	float lookup( uint32_t phase, uint32_t tableOffset = 0 ) const
+	{
+		const uint32_t index1 = phase >> mShift;
+		const uint32_t index2 = ( index1 + 1 ) & mIndexMask;
+		const float frac = float( phase & mFracMask ) * mFracScale;
+		const float val1 = mData[tableOffset + index1];
+
+		return val1 + frac * ( mData[tableOffset + index2] - val1 );
+	}
+
+	const float	*mData;
+	uint32_t	mLog2Size, mShift, mIndexMask, mFracMask;
+	float		mFracScale;
+};
+
+// Computes the offset of the bandlimited table for f0 within a WaveTable2d's contiguous storage without branching, equivalent
+// to WaveTable2d::calcBandlimitedTableIndex() but using fastLog2() in place of toMidi().
+struct TableSelector {
+	TableSelector()
+		: mScale( 0 ), mOffset( 0 ), mMaxIndex( 0 ), mLog2TableSize( 0 )
+	{}
+
+	TableSelector( float minMidi, float maxMidi, size_t numTables, uint32_t log2TableSize )
+		: mMaxIndex( float( numTables - 1 ) ), mLog2TableSize( log2TableSize )
+	{
+		const float tablesPerMidi = numTables > 1 ? float( numTables - 1 ) / ( maxMidi - minMidi ) : 0;
+		mScale = 12 * tablesPerMidi;
+		mOffset = 1 + ( kMidiOffset - minMidi ) * tablesPerMidi;
+	}
+
+	uint32_t calcOffset( float f0 ) const
+	{
+		float index = fastLog2( fabsf( f0 ) ) * mScale + mOffset;
+		index = min( max( index, 0.0f ), mMaxIndex );
+		return uint32_t( index ) << mLog2TableSize;
+	}
+
+	float		mScale, mOffset, mMaxIndex;
+	uint32_t	mLog2TableSize;
+};
+
+#if defined( CINDER_AUDIO_SSE )
+
+// FixedTable and TableSelector constants, splatted across four lanes
+struct LanesSse {
+	LanesSse( const FixedTable &table, const TableSelector &selector )
+	{
+		mShift = _mm_cvtsi32_si128( (int)table.mShift );
+		mIndexMask = _mm_set1_epi32( (int)table.mIndexMask );
+		mFracMask = _mm_set1_epi32( (int)table.mFracMask );
+		mFracScale = _mm_set1_ps( table.mFracScale );
+
+		mSelectScale = _mm_set1_ps( selector.mScale );
+		mSelectOffset = _mm_set1_ps( selector.mOffset );
+		mSelectMaxIndex = _mm_set1_ps( selector.mMaxIndex );
+		mLog2TableSize = _mm_cvtsi32_si128( (int)selector.mLog2TableSize );
+	}
+
+	__m128i	mShift, mIndexMask, mFracMask, mLog2TableSize;
+	__m128	mFracScale, mSelectScale, mSelectOffset, mSelectMaxIndex;
+};
+
+// Looks up and interpolates four phases, each offset by the matching lane in \a tableOffsets.
+inline __m128 lookupLanes( const float *data, const LanesSse &lanes, __m128i phases, __m128i tableOffsets )
+{
+	const __m128i index1 = _mm_srl_epi32( phases, lanes.mShift );
+	const __m128i index2 = _mm_and_si128( _mm_add_epi32( index1, _mm_set1_epi32( 1 ) ), lanes.mIndexMask );
+	const __m128 frac = _mm_mul_ps( _mm_cvtepi32_ps( _mm_and_si128( phases, lanes.mFracMask ) ), lanes.mFracScale );
+
+	// SSE2 has no gather, so the eight samples are loaded individually from the computed indices
+	int32_t i1[4], i2[4];
+	_mm_storeu_si128( (__m128i *)i1, _mm_add_epi32( index1, tableOffsets ) );
+	_mm_storeu_si128( (__m128i *)i2, _mm_add_epi32( index2, tableOffsets ) );
+
+	const __m128 val1 = _mm_setr_ps( data[i1[0]], data[i1[1]], data[i1[2]], data[i1[3]] );
+	const __m128 val2 = _mm_setr_ps( data[i2[0]], data[i2[1]], data[i2[2]], data[i2[3]] );
+
+	return _mm_add_ps( val1, _mm_mul_ps( frac, _mm_sub_ps( val2, val1 ) ) );
+}
+
+// Vector TableSelector::calcOffset(), out of range or NaN indices are clamped by max / min.
+inline __m128i selectTableLanes( const LanesSse &lanes, __m128 f0 )
+{
+	const __m128i bits = _mm_and_si128( _mm_castps_si128( f0 ), _mm_set1_epi32( 0x7FFFFFFF ) ); // fabs
+	const __m128 exponent = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_srli_epi32( bits, 23 ), _mm_set1_epi32( 127 ) ) );
+	const __m128 m = _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( bits, _mm_set1_epi32( 0x007FFFFF ) ), _mm_set1_epi32( 0x3F800000 ) ) );
+
+	__m128 log2 = _mm_add_ps( _mm_set1_ps( -1.0295584f ), _mm_mul_ps( m, _mm_set1_ps( 0.15392465f ) ) );
+	log2 = _mm_add_ps( _mm_set1_ps( 3.0108510f ), _mm_mul_ps( m, log2 ) );
+	log2 = _mm_add_ps( _mm_set1_ps( -2.1338866f ), _mm_mul_ps( m, log2 ) );
+	log2 = _mm_add_ps( exponent, log2 );
+
+	__m128 index = _mm_add_ps( _mm_mul_ps( log2, lanes.mSelectScale ), lanes.mSelectOffset );
+	index = _mm_min_ps( _mm_max_ps( index, _mm_setzero_ps() ), lanes.mSelectMaxIndex );
+
+	return _mm_sll_epi32( _mm_cvttps_epi32( index ), lanes.mLog2TableSize );
+}
+
+#endif // defined( CINDER_AUDIO_SSE )
+
+// Fills \a output from a single table with a constant phase increment. Returns the phase following the last sample.
+uint32_t lookupFixed( const FixedTable &table, float *output, size_t length, uint32_t phase, uint32_t incr )
+{
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	const LanesSse lanes( table, TableSelector() );
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i step = _mm_set1_epi32( int( incr * 4 ) );
+	__m128i phases = _mm_add_epi32( _mm_set1_epi32( (int)phase ), _mm_setr_epi32( 0, (int)incr, int( incr * 2 ), int( incr * 3 ) ) );
+
+	for( ; i + 4 <= length; i += 4 ) {
+		_mm_storeu_ps( output + i, lookupLanes( table.mData, lanes, phases, zero ) );
+		phases = _mm_add_epi32( phases, step );
+	}
+
+	phase += uint32_t( i ) * incr;
+#endif
+
+	for( ; i < length; i++ ) {
+		output[i] = table.lookup( phase );
+		phase += incr;
+	}
+
+	return phase;
+}
+
+// Fills \a output with a per-sample frequency. If SelectTable is true, \a table is the contiguous storage of a WaveTable2d and the bandlimited
+// table for each sample is chosen by \a selector. Returns the phase following the last sample.
+template <bool SelectTable>
+uint32_t lookupFixed( const FixedTable &table, const TableSelector &selector, float *output, size_t length, uint32_t phase, const float *freqArray, float samplePeriod )
+{
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	const LanesSse lanes( table, selector );
+	const __m128 period = _mm_set1_ps( samplePeriod );
+	const __m128 fixedScale = _mm_set1_ps( (float)kFixedPhaseScale );
+
+	for( ; i + 4 <= length; i += 4 ) {
+		const __m128 freqs = _mm_loadu_ps( freqArray + i );
+
+		// remove whole cycles so the fixed point increment fits in 32 bits: [-0.5:0.5] * 2^32 (+2^31 saturates to -2^31, which is the same phase)
+		__m128 cycles = _mm_mul_ps( freqs, period );
+		cycles = _mm_sub_ps( cycles, _mm_cvtepi32_ps( _mm_cvtps_epi32( cycles ) ) );
+		const __m128i incr = _mm_cvtps_epi32( _mm_mul_ps( cycles, fixedScale ) );
+
+		// inclusive prefix sum of the increments, each sample's phase is the current phase plus the exclusive sum
+		__m128i sum = _mm_add_epi32( incr, _mm_slli_si128( incr, 4 ) );
+		sum = _mm_add_epi32( sum, _mm_slli_si128( sum, 8 ) );
+		const __m128i phases = _mm_add_epi32( _mm_set1_epi32( (int)phase ), _mm_sub_epi32( sum, incr ) );
+
+		const __m128i tableOffsets = SelectTable ? selectTableLanes( lanes, freqs ) : _mm_setzero_si128();
+		_mm_storeu_ps( output + i, lookupLanes( table.mData, lanes, phases, tableOffsets ) );
+
+		phase += (uint32_t)_mm_cvtsi128_si32( _mm_shuffle_epi32( sum, _MM_SHUFFLE( 3, 3, 3, 3 ) ) );
+	}
+#endif
+
+	for( ; i < length; i++ ) {
+		const float f0 = freqArray[i];
+		output[i] = table.lookup( phase, SelectTable ? selector.calcOffset( f0 ) : 0 );
+		phase += toFixedIncr( double( f0 ) * samplePeriod );
+	}
+
+	return phase;
+}
+
+// FixedTable indexes with the upper bits of the phase, so table sizes are rounded up to a power of two.
+size_t toValidTableSize( size_t tableSize )
+{
+	if( tableSize < 2 )
+		return 2;
+
+	return isPowerOf2( tableSize ) ? tableSize : nextPowerOf2( static_cast<uint32_t>( tableSize ) );
+}
+
+} // anonymous namespace
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - WaveTable
 // ----------------------------------------------------------------------------------------------------
 
 WaveTable::WaveTable( size_t sampleRate, size_t tableSize )
-	: mTableSize( tableSize )
+	: mTableSize( toValidTableSize( tableSize ) )
 {
 	setSampleRate( sampleRate );
 }
 
+WaveTable::~WaveTable()
+{
+}
+
 void WaveTable::setSampleRate( size_t sampleRate )
 {
 	CI_ASSERT( sampleRate );
@@ -99,6 +353,7 @@ void WaveTable::setSampleRate( size_t sampleRate )
 
 void WaveTable::resize( size_t tableSize )
 {
+	tableSize = toValidTableSize( tableSize );
 	if( mTableSize == tableSize && mBuffer.getNumFrames() == tableSize )
 		return;
 
@@ -116,6 +371,27 @@ void WaveTable::fillSine()
 
 void WaveTable::fillSinesum( float *array, size_t length, const std::vector<float> &partials )
 {
+	if( length >= 4 && isPowerOf2( length ) ) {
+		if( ! mFft || mFft->getSize() != length ) {
+			mFft.reset( new Fft( length ) );
+			mSpectralBuffer = BufferSpectral( length );
+			mFftBuffer = Buffer( length );
+		}
+
+		// partials that would fall on or above nyquist can't be represented in the table (bin 0 of the imaginary part holds nyquist's real part)
+		const size_t numPartials = min( partials.size(), length / 2 - 1 );
+		const float binScale = calcSineBinScale( length );
+		float *imag = mSpectralBuffer.getImag();
+
+		mSpectralBuffer.zero();
+		for( size_t p = 0; p < numPartials; p++ )
+			imag[p + 1] = partials[p] * binScale;
+
+		mFft->inverse( &mSpectralBuffer, &mFftBuffer );
+		memcpy( array, mFftBuffer.getData(), length * sizeof( float ) );
+		return;
+	}
+
 	memset( array, 0, length * sizeof( float ) );
 
 	double phase = 0;
@@ -139,30 +415,18 @@ float WaveTable::lookup( float phase ) const
 
 float WaveTable::lookup( float *outputArray, size_t outputLength, float currentPhase, float freq ) const
 {
-	const float phaseIncr = freq * mSamplePeriod;
-	const float *table = mBuffer.getData();
-	const size_t tableSize = mTableSize;
-
-	for( size_t i = 0; i < outputLength; i++ ) {
-		outputArray[i] = tableLookup( table, tableSize, currentPhase );
-		currentPhase = wrap( currentPhase + phaseIncr );
-	}
+	const FixedTable table( mBuffer.getData(), mTableSize );
+	uint32_t phase = lookupFixed( table, outputArray, outputLength, toFixedPhase( currentPhase ), toFixedIncr( double( freq ) * mSamplePeriod ) );
 
-	return currentPhase;
+	return fromFixedPhase( phase );
 }
 
 float WaveTable::lookup( float *outputArray, size_t outputLength, float currentPhase, const float *freqArray ) const
 {
-	const size_t tableSize = mTableSize;
-	const float samplePeriod = mSamplePeriod;
-	const float *table = mBuffer.getData();
+	const FixedTable table( mBuffer.getData(), mTableSize );
+	uint32_t phase = lookupFixed<false>( table, TableSelector(), outputArray, outputLength, toFixedPhase( currentPhase ), freqArray, mSamplePeriod );
 
-	for( size_t i = 0; i < outputLength; i++ ) {
-		outputArray[i] = tableLookup( table, tableSize, currentPhase );
-		currentPhase = wrap( currentPhase + freqArray[i] * samplePeriod );
-	}
-	
-	return currentPhase;
+	return fromFixedPhase( phase );
 }
 
 void WaveTable::copyTo( float *array ) const
@@ -186,6 +450,8 @@ WaveTable2d::WaveTable2d( size_t sampleRate, size_t tableSize, size_t numTables
 
 void WaveTable2d::resize( size_t tableSize, size_t numTables )
 {
+	tableSize = toValidTableSize( tableSize );
+
 	bool needsResize = false;
 	if( mTableSize != tableSize || mBuffer.getNumFrames() != tableSize ) {
 		mTableSize = tableSize;
@@ -342,32 +608,20 @@ float WaveTable2d::lookupBandlimited( float phase, float f0 ) const
 
 float WaveTable2d::lookupBandlimited( float *outputArray, size_t outputLength, float currentPhase, float f0 ) const
 {
-	const float phaseIncr = f0 * mSamplePeriod;
-	const float *table = getBandLimitedTable( f0 );
-	const size_t tableSize = mTableSize;
-
-	for( size_t i = 0; i < outputLength; i++ ) {
-		outputArray[i] = tableLookup( table, tableSize, currentPhase );
-		currentPhase = wrap( currentPhase + phaseIncr );
-	}
+	const FixedTable table( getBandLimitedTable( f0 ), mTableSize );
+	uint32_t phase = lookupFixed( table, outputArray, outputLength, toFixedPhase( currentPhase ), toFixedIncr( double( f0 ) * mSamplePeriod ) );
 
-	return currentPhase;
+	return fromFixedPhase( phase );
 }
 
 float WaveTable2d::lookupBandlimited( float *outputArray, size_t outputLength, float currentPhase, const float *f0Array ) const
 {
-	const size_t tableSize = mTableSize;
-	const float samplePeriod = mSamplePeriod;
-
-	for( size_t i = 0; i < outputLength; i++ ) {
-		const float f0 = f0Array[i];
-		const float *table = getBandLimitedTable( f0 );
-
-		outputArray[i] = tableLookup( table, tableSize, currentPhase );
-		currentPhase = wrap( currentPhase + f0 * samplePeriod );
-	}
+	// all tables are contiguous, so the per-sample table selection is an offset from the first
+	const FixedTable table( mBuffer.getData(), mTableSize );
+	const TableSelector selector( mMinMidiRange, mMaxMidiRange, mNumTables, table.mLog2Size );
+	uint32_t phase = lookupFixed<true>( table, selector, outputArray, outputLength, toFixedPhase( currentPhase ), f0Array, mSamplePeriod );
 
-	return currentPhase;
+	return fromFixedPhase( phase );
 }
 
 #else
@@ -431,4 +685,67 @@ void WaveTable2d::calcLimits()
 	mMaxMidiRange = toMidi( (float)mSampleRate / 4.0f ); // everything above can only have one partial
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - WaveTableCache
+// ----------------------------------------------------------------------------------------------------
+
+namespace {
+
+typedef tuple<WaveformType, size_t, size_t, size_t>		WaveTableKey;
+typedef map<WaveTableKey, weak_ptr<WaveTable2d> >		WaveTableMap;
+
+struct WaveTableCacheStorage {
+	mutex			mMutex;
+	WaveTableMap	mTables;
+};
+
+WaveTableCacheStorage* getWaveTableCacheStorage()
+{
+	static WaveTableCacheStorage sStorage;
+	return &sStorage;
+}
+
+} // anonymous namespace
+
+WaveTable2dRef WaveTableCache::getBandlimited( WaveformType type, size_t sampleRate, size_t tableSize, size_t numTables )
+{
+	WaveTableCacheStorage *storage = getWaveTableCacheStorage();
+	lock_guard<mutex> lock( storage->mMutex );
+
+	// drop entries whose tables have been released since the last request
+	for( auto it = storage->mTables.begin(); it != storage->mTables.end(); ) {
+		if( it->second.expired() )
+			it = storage->mTables.erase( it );
+		else
+			++it;
+	}
+
+	// rounded as WaveTable2d would, so that requests for sizes that end up the same share one table set
+	tableSize = toValidTableSize( tableSize );
+
+	const WaveTableKey key( type, sampleRate, tableSize, numTables );
+	WaveTable2dRef result = storage->mTables[key].lock();
+	if( ! result ) {
+		result = make_shared<WaveTable2d>( sampleRate, tableSize, numTables );
+		result->fillBandlimited( type );
+		storage->mTables[key] = result;
+	}
+
+	return result;
+}
+
+size_t WaveTableCache::getNumCachedTables()
+{
+	WaveTableCacheStorage *storage = getWaveTableCacheStorage();
+	lock_guard<mutex> lock( storage->mMutex );
+
+	size_t result = 0;
+	for( const auto &entry : storage->mTables ) {
+		if( ! entry.second.expired() )
+			result++;
+	}
+
+	return result;
+}
+
 } } } // namespace cinder::audio2::dsp
\ No newline at end of file
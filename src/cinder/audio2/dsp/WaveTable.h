@@ -26,6 +26,7 @@
 #include "cinder/audio2/WaveformType.h"
 #include "cinder/audio2/Buffer.h"
 
+#include <memory>
 #include <vector>
 #include <tuple>
 
@@ -34,10 +35,15 @@ namespace cinder { namespace audio2 { namespace dsp {
 typedef std::shared_ptr<class WaveTable>		WaveTableRef;
 typedef std::shared_ptr<class WaveTable2d>		WaveTable2dRef;
 
+class Fft;
+
 class WaveTable {
   public:
+	//! Constructs a WaveTable of \a tableSize samples, which is rounded up to the next power of two.
 	WaveTable( size_t mSampleRate, size_t tableSize );
+	~WaveTable();
 
+	//! Resizes the table to \a tableSize samples, rounded up to the next power of two.
 	void resize( size_t tableSize );
 
 	void fillSine();
@@ -56,18 +62,25 @@ class WaveTable {
 	void copyFrom( const float *array );
 
   protected:
+	//! Fills \a array with the sum of sines at each harmonic, where \a partialCoeffs[0] is the amplitude of the fundamental.
+	//! When \a length is a power of two, this is done with a single inverse FFT of the harmonic spectrum.
 	void		fillSinesum( float *array, size_t length, const std::vector<float> &partialCoeffs );
 
 	size_t			mSampleRate, mTableSize;
 	float			mSamplePeriod;
 	BufferDynamic	mBuffer;
+
+	// used by fillSinesum(), allocated on first use
+	std::unique_ptr<Fft>	mFft;
+	BufferSpectral			mSpectralBuffer;
+	Buffer					mFftBuffer;
 };
 
 class WaveTable2d : public WaveTable {
   public:
 	WaveTable2d( size_t sampleRate, size_t tableSize, size_t numTables );
 
-	//! Adjusts the parameters effecting table size and calculate.
+	//! Adjusts the parameters effecting table size and calculate. \a tableSize is rounded up to the next power of two.
 	//! \note This does not update the data, call fill() afterwards to refresh the table contents.
 	void resize( size_t tableSize, size_t numTables );
 
@@ -96,4 +109,17 @@ class WaveTable2d : public WaveTable {
 	float			mMinMidiRange, mMaxMidiRange;
 };
 
+//! \brief Process-wide cache of bandlimited WaveTable2d's.
+//!
+//! Table sets are keyed by waveform, samplerate, table size and number of tables. The cache only holds weak references, so a table set is shared
+//! by everything that requests the same parameters and is freed when the last reference is released. Tables returned from the cache are shared
+//! and must be treated as read-only, use a separately constructed WaveTable2d in order to modify its contents.
+class WaveTableCache {
+  public:
+	//! Returns a WaveTable2d filled with bandlimited \a type, filling a new one if none with the same parameters is alive. Safe to call from any non-audio thread.
+	static WaveTable2dRef	getBandlimited( WaveformType type, size_t sampleRate, size_t tableSize, size_t numTables );
+	//! Returns the number of table sets that are currently alive in the cache.
+	static size_t			getNumCachedTables();
+};
+
 } } } // namespace cinder::audio2::dsp
\ No newline at end of file
@@ -0,0 +1,161 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio2/dsp/Yin.h"
+#include "cinder/audio2/dsp/Fft.h"
+#include "cinder/audio2/Utilities.h"
+#include "cinder/audio2/CinderAssert.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+// The vDSP forward transform is scaled by two, so the product of two spectra is scaled by four while the inverse only removes a factor of two.
+#if defined( CINDER_AUDIO_VDSP )
+	const float kCorrelationScale = 0.5f;
+#else
+	const float kCorrelationScale = 1.0f;
+#endif
+
+Yin::Yin( size_t windowSize )
+	: mWindowSize( windowSize ), mThreshold( 0.15f ), mConfidence( 0 )
+{
+	if( mWindowSize < 8 )
+		mWindowSize = 8;
+	else if( ! isPowerOf2( mWindowSize ) )
+		mWindowSize = nextPowerOf2( static_cast<uint32_t>( mWindowSize ) );
+
+	mFft.reset( new Fft( mWindowSize ) );
+	mWindowBuffer = Buffer( mWindowSize );
+	mHalfBuffer = Buffer( mWindowSize );
+	mWindowSpectral = BufferSpectral( mWindowSize );
+	mHalfSpectral = BufferSpectral( mWindowSize );
+	mEnergy.resize( mWindowSize + 1 );
+	mDifference.resize( mWindowSize / 2 );
+
+	setPeriodRange( 2, mWindowSize / 2 - 1 );
+}
+
+Yin::~Yin()
+{
+}
+
+void Yin::setPeriodRange( size_t minPeriod, size_t maxPeriod )
+{
+	mMaxPeriod = max<size_t>( 3, min( maxPeriod, mWindowSize / 2 - 1 ) );
+	mMinPeriod = max<size_t>( 2, min( minPeriod, mMaxPeriod - 1 ) );
+}
+
+float Yin::detectPeriod( const float *window )
+{
+	const size_t integrationSize = mWindowSize / 2;
+
+	mEnergy[0] = 0;
+	for( size_t i = 0; i < mWindowSize; i++ )
+		mEnergy[i + 1] = mEnergy[i] + double( window[i] ) * double( window[i] );
+
+	// silence has no period, and would only produce a noisy estimate below.
+	if( mEnergy[integrationSize] < 1e-10 ) {
+		mConfidence = 0;
+		return 0;
+	}
+
+	computeDifference( window );
+
+	// absolute threshold: take the first dip below the threshold, then follow it down to its local minimum.
+	size_t tau = mMinPeriod;
+	for( ; tau < mMaxPeriod; tau++ ) {
+		if( mDifference[tau] < mThreshold ) {
+			while( tau + 1 < mMaxPeriod && mDifference[tau + 1] < mDifference[tau] )
+				tau++;
+			break;
+		}
+	}
+
+	if( tau == mMaxPeriod ) {
+		mConfidence = 1.0f - *min_element( mDifference.begin() + mMinPeriod, mDifference.begin() + mMaxPeriod );
+		return 0;
+	}
+
+	mConfidence = max( 0.0f, 1.0f - mDifference[tau] );
+
+	// parabolic interpolation around the chosen lag for sub-sample accuracy.
+	const float prev = mDifference[tau - 1];
+	const float curr = mDifference[tau];
+	const float next = mDifference[tau + 1];
+	const float denom = prev - 2 * curr + next;
+	if( denom > 0 )
+		return (float)tau + 0.5f * ( prev - next ) / denom;
+
+	return (float)tau;
+}
+
+// Computes the cumulative mean normalized difference d'(tau) for tau in [0, windowSize / 2). The squared difference is expanded as
+// d(tau) = e(0) + e(tau) - 2 r(tau), where e(tau) is the energy of the integration window starting at tau (taken from mEnergy) and
+// r(tau) is the cross-correlation of the first half of the window with the whole window, computed through the FFT.
+void Yin::computeDifference( const float *window )
+{
+	const size_t integrationSize = mWindowSize / 2;
+	const size_t numBins = mWindowSize / 2;
+
+	memcpy( mWindowBuffer.getData(), window, mWindowSize * sizeof( float ) );
+	memcpy( mHalfBuffer.getData(), window, integrationSize * sizeof( float ) );
+	mHalfBuffer.zero( integrationSize, mWindowSize - integrationSize );
+
+	mFft->forward( &mWindowBuffer, &mWindowSpectral );
+	mFft->forward( &mHalfBuffer, &mHalfSpectral );
+
+	// multiply the window spectrum by the complex conjugate of the half window spectrum. Bin 0 holds the DC and nyquist components, both real.
+	float *re = mHalfSpectral.getReal();
+	float *im = mHalfSpectral.getImag();
+	const float *windowRe = mWindowSpectral.getReal();
+	const float *windowIm = mWindowSpectral.getImag();
+
+	re[0] *= windowRe[0];
+	im[0] *= windowIm[0];
+	for( size_t k = 1; k < numBins; k++ ) {
+		float a = re[k];
+		float b = im[k];
+		re[k] = a * windowRe[k] + b * windowIm[k];
+		im[k] = a * windowIm[k] - b * windowRe[k];
+	}
+
+	// mHalfBuffer now holds the cross-correlation. Wrap-around can't occur because the half window was zero padded to the full size.
+	mFft->inverse( &mHalfSpectral, &mHalfBuffer );
+	const float *correlation = mHalfBuffer.getData();
+
+	const double e0 = mEnergy[integrationSize];
+	double runningSum = 0;
+	mDifference[0] = 1;
+	for( size_t tau = 1; tau < integrationSize; tau++ ) {
+		double et = mEnergy[tau + integrationSize] - mEnergy[tau];
+		double diff = max( 0.0, e0 + et - 2.0 * kCorrelationScale * correlation[tau] );
+
+		runningSum += diff;
+		mDifference[tau] = runningSum > 0 ? float( diff * tau / runningSum ) : 1.0f;
+	}
+}
+
+} } } // namespace cinder::audio2::dsp
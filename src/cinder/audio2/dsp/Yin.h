@@ -0,0 +1,72 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio2/Buffer.h"
+
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+class Fft;
+
+//! \brief Fundamental period estimator based on the YIN algorithm (de Cheveigne & Kawahara, 2002).
+//!
+//! The difference function is computed from an FFT-based cross-correlation, so each analysis costs O(N log N) rather than the O(N^2) of the
+//! direct method. Each analysis integrates over the first half of the window, so the longest detectable period is windowSize / 2 samples.
+//! All memory is allocated at construction, detectPeriod() is safe to call on the audio thread.
+class Yin {
+  public:
+	//! Constructs a Yin detector that analyzes \a windowSize samples at a time. \a windowSize will be rounded up to the nearest power of two.
+	Yin( size_t windowSize );
+	~Yin();
+
+	//! Analyzes getWindowSize() samples starting at \a window. Returns the detected fundamental period in (fractional) samples, or 0 if the window is unvoiced.
+	float detectPeriod( const float *window );
+
+	//! Sets the threshold (0 - 1, default = 0.15) on the cumulative mean normalized difference below which a period is accepted. Lower values reject noisier frames.
+	void	setThreshold( float threshold )		{ mThreshold = threshold; }
+	//! Returns the threshold on the cumulative mean normalized difference.
+	float	getThreshold() const				{ return mThreshold; }
+	//! Sets the range of periods (in samples) that are searched. \a maxPeriod is clipped to getWindowSize() / 2 - 1.
+	void	setPeriodRange( size_t minPeriod, size_t maxPeriod );
+	//! Returns the confidence (0 - 1) of the last call to detectPeriod(), computed as one minus the aperiodicity at the chosen period.
+	float	getConfidence() const				{ return mConfidence; }
+	//! Returns the number of samples analyzed by detectPeriod().
+	size_t	getWindowSize() const				{ return mWindowSize; }
+
+  private:
+	void computeDifference( const float *window );
+
+	std::unique_ptr<Fft>	mFft;
+	Buffer					mWindowBuffer, mHalfBuffer;			// time-domain window and its zero padded first half
+	BufferSpectral			mWindowSpectral, mHalfSpectral;
+	std::vector<double>		mEnergy;							// running sum of squares, mEnergy[i] = sum of x[0, i)
+	std::vector<float>		mDifference;						// cumulative mean normalized difference, one per lag
+	size_t					mWindowSize, mMinPeriod, mMaxPeriod;
+	float					mThreshold, mConfidence;
+};
+
+} } } // namespace cinder::audio2::dsp
@@ -27,6 +27,8 @@ class NodeEffectTestApp : public AppNative {
 	void setupFeedback();
 	void setupEcho();
 	void setupCycle();
+	void setupSvfSweep();
+	void setupEq();
 
 	void makeNodes();
 	void switchTest( const string &currentTest );
@@ -40,6 +42,8 @@ class NodeEffectTestApp : public AppNative {
 	audio2::GainRef				mGain;
 	audio2::Pan2dRef			mPan;
 	audio2::FilterLowPassRef	mLowPass;
+	audio2::FilterSvfRef		mSvf;
+	audio2::FilterEqRef			mEq;
 	audio2::DelayRef			mDelay;
 
 	vector<TestWidget *>	mWidgets;
@@ -93,6 +97,15 @@ void NodeEffectTestApp::makeNodes()
 	mLowPass->setCutoffFreq( 400 );
 //	mLowPass = ctx->makeNode( new audio2::FilterHighPass() );
 
+	mSvf = ctx->makeNode( new audio2::FilterSvf() );
+	mSvf->setResonance( 4 );
+
+	mEq = ctx->makeNode( new audio2::FilterEq( 4 ) );
+	mEq->setBand( 0, audio2::FilterBiquad::HIGHPASS, 60, 0 );
+	mEq->setBand( 1, audio2::FilterBiquad::PEAKING, 400, 2, -6 );
+	mEq->setBand( 2, audio2::FilterBiquad::PEAKING, 2500, 1, 4 );
+	mEq->setBand( 3, audio2::FilterBiquad::HIGHSHELF, 8000, 1, -3 );
+
 	mDelay = ctx->makeNode( new audio2::Delay );
 	mDelay->setDelaySeconds( 0.5f );
 //	mDelay->setDelaySeconds( 100.0f / (float)ctx->getSampleRate() );
@@ -165,6 +178,20 @@ void NodeEffectTestApp::setupCycle()
 	}
 }
 
+void NodeEffectTestApp::setupSvfSweep()
+{
+	mGen >> mSvf >> mGain >> mPan >> audio2::master()->getOutput();
+
+	// sweep the cutoff up and back down, coefficients are interpolated per-sample
+	mSvf->getParamCutoffFreq()->applyRamp( 100, 5000, 2, audio2::Param::Options().rampType( audio2::RampType::EXPONENTIAL ) );
+	mSvf->getParamCutoffFreq()->appendRamp( 100, 2, audio2::Param::Options().rampType( audio2::RampType::EXPONENTIAL ) );
+}
+
+void NodeEffectTestApp::setupEq()
+{
+	mGen >> mEq >> mGain >> mPan >> audio2::master()->getOutput();
+}
+
 void NodeEffectTestApp::applyChirp()
 {
 	mGen->getParamFreq()->applyRamp( 440, 00, 0.15f );
@@ -206,6 +233,8 @@ void NodeEffectTestApp::setupUI()
 	mTestSelector.mSegments.push_back( "feedback" );
 	mTestSelector.mSegments.push_back( "echo" );
 	mTestSelector.mSegments.push_back( "cycle" );
+	mTestSelector.mSegments.push_back( "svf sweep" );
+	mTestSelector.mSegments.push_back( "eq" );
 	mTestSelector.mBounds = Rectf( (float)getWindowWidth() * 0.67f, 0, (float)getWindowWidth(), 200 );
 	mWidgets.push_back( &mTestSelector );
 
@@ -253,8 +282,10 @@ void NodeEffectTestApp::processDrag( Vec2i pos )
 		mGain->getParam()->applyRamp( mGainSlider.mValueScaled, 0.015f );
 	if( mPanSlider.hitTest( pos ) )
 		mPan->setPos( mPanSlider.mValueScaled );
-	if( mLowPassFreqSlider.hitTest( pos ) )
+	if( mLowPassFreqSlider.hitTest( pos ) ) {
 		mLowPass->setCutoffFreq( mLowPassFreqSlider.mValueScaled );
+		mEq->setBandFreq( 1, mLowPassFreqSlider.mValueScaled );
+	}
 	if( mFilterParam2Slider.hitTest( pos ) )
 		mLowPass->setResonance( mFilterParam2Slider.mValueScaled );
 }
@@ -311,6 +342,10 @@ void NodeEffectTestApp::switchTest( const string &currentTest )
 		setupEcho();
 	else if( currentTest == "cycle" )
 		setupCycle();
+	else if( currentTest == "svf sweep" )
+		setupSvfSweep();
+	else if( currentTest == "eq" )
+		setupEq();
 
 	ctx->setEnabled( enabled );
 	ctx->printGraph();
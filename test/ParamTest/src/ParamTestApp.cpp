@@ -36,6 +36,7 @@ class ParamTestApp : public AppNative {
 	void testDelay();
 	void testAppendCancel();
 	void testProcessor();
+	void testModulationBus();
 
 	void writeParamEval( audio2::Param *param );
 
@@ -45,7 +46,7 @@ class ParamTestApp : public AppNative {
 	audio2::FilterLowPassRef	mLowPass;
 
 	vector<TestWidget *>	mWidgets;
-	Button					mPlayButton, mApplyButton, mApplyAppendButton, mAppendButton, mDelayButton, mProcessorButton, mAppendCancelButton;
+	Button					mPlayButton, mApplyButton, mApplyAppendButton, mAppendButton, mDelayButton, mProcessorButton, mAppendCancelButton, mModulationBusButton;
 	VSelector				mTestSelector;
 	HSlider					mGainSlider, mPanSlider, mLowPassFreqSlider, mGenFreqSlider;
 };
@@ -153,6 +154,18 @@ void ParamTestApp::testProcessor()
 	mGain->getParam()->setProcessor( mod );
 }
 
+// one lfo shared by the gain and frequency Params, each with its own depth and offset
+void ParamTestApp::testModulationBus()
+{
+	auto ctx = audio2::master();
+	auto lfo = ctx->makeNode( new audio2::GenSine( audio2::Node::Format().autoEnable() ) );
+	lfo->setFreq( 0.5f );
+
+	auto bus = audio2::ModulationBus::create( lfo );
+	mGain->getParam()->setModulation( bus, 0.3f, 0.5f );
+	mGen->getParamFreq()->setModulation( bus, 50, mGen->getFreq() );
+}
+
 void ParamTestApp::setupUI()
 {
 	const float padding = 10.0f;
@@ -191,6 +204,11 @@ void ParamTestApp::setupUI()
 	mAppendCancelButton.mBounds = paramButtonRect;
 	mWidgets.push_back( &mAppendCancelButton );
 
+	paramButtonRect += Vec2f( paramButtonRect.getWidth() + padding, 0 );
+	mModulationBusButton = Button( false, "mod bus" );
+	mModulationBusButton.mBounds = paramButtonRect;
+	mWidgets.push_back( &mModulationBusButton );
+
 	mTestSelector.mSegments.push_back( "basic" );
 	mTestSelector.mSegments.push_back( "filter" );
 	mTestSelector.mBounds = Rectf( (float)getWindowWidth() * 0.67f, 0, (float)getWindowWidth(), 160 );
@@ -248,7 +266,7 @@ void ParamTestApp::processDrag( Vec2i pos )
 	if( mGenFreqSlider.hitTest( pos ) ) {
 //		mGen->setFreq( mGenFreqSlider.mValueScaled );
 //		mGen->getParamFreq()->applyRamp( mGenFreqSlider.mValueScaled, 0.3f );
-		mGen->getParamFreq()->applyRamp( mGenFreqSlider.mValueScaled, 0.3f, audio2::Param::Options().rampFn( &audio2::rampOutQuad ) );
+		mGen->getParamFreq()->applyRamp( mGenFreqSlider.mValueScaled, 0.3f, audio2::Param::Options().rampType( audio2::RampType::OUT_QUAD ) );
 	}
 	if( mLowPassFreqSlider.hitTest( pos ) )
 		mLowPass->setCutoffFreq( mLowPassFreqSlider.mValueScaled );
@@ -273,6 +291,8 @@ void ParamTestApp::processTap( Vec2i pos )
 		testProcessor();
 	else if( mAppendCancelButton.hitTest( pos ) )
 		testAppendCancel();
+	else if( mModulationBusButton.hitTest( pos ) )
+		testModulationBus();
 	else if( mTestSelector.hitTest( pos ) && selectorIndex != mTestSelector.mCurrentSectionIndex ) {
 		string currentTest = mTestSelector.currentSection();
 		CI_LOG_V( "selected: " << currentTest );
@@ -319,11 +339,11 @@ void ParamTestApp::writeParamEval( audio2::Param *param )
 {
 	auto ctx = audio2::master();
 	float duration = param->findDuration();
-	float currTime = (float)ctx->getNumProcessedSeconds();
+	uint64_t currFrame = ctx->getNumProcessedFrames();
 	size_t sampleRate = ctx->getSampleRate();
 	audio2::Buffer audioBuffer( (size_t)duration * sampleRate );
 
-	param->eval( currTime, audioBuffer.getData(), audioBuffer.getSize(), sampleRate );
+	param->eval( currFrame, audioBuffer.getData(), audioBuffer.getSize() );
 
 	auto target = audio2::TargetFile::create( "param.wav", sampleRate, 1 );
 	target->write( &audioBuffer );
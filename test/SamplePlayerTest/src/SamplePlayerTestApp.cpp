@@ -2,11 +2,13 @@
 #include "cinder/gl/gl.h"
 #include "cinder/Timeline.h"
 #include "cinder/Timer.h"
+#include "cinder/Rand.h"
 
 #include "cinder/audio2/Source.h"
 #include "cinder/audio2/Target.h"
 #include "cinder/audio2/dsp/Converter.h"
 #include "cinder/audio2/SamplePlayer.h"
+#include "cinder/audio2/Sampler.h"
 #include "cinder/audio2/NodeEffect.h"
 #include "cinder/audio2/Scope.h"
 #include "cinder/audio2/Debug.h"
@@ -43,6 +45,7 @@ class SamplePlayerTestApp : public AppNative {
 	void setupBufferPlayer();
 	void setupBufferPlayerRaw();
 	void setupFilePlayer();
+	void setupSampler();
 	void setSourceFile( const DataSourceRef &dataSource );
 
 	void setupUI();
@@ -50,26 +53,32 @@ class SamplePlayerTestApp : public AppNative {
 	void processTap( Vec2i pos );
 
 	void seek( size_t xPos );
+	void setShortLoop();
+	void seekToNextCuePoint();
 	void printBufferSamples( size_t xPos );
 
 	void testConverter();
 	void testWrite();
+	void testSamplerVoiceStealing();
 
 	audio2::SamplePlayerRef		mSamplePlayer;
 	audio2::SourceFileRef		mSourceFile;
 	audio2::ScopeRef			mScope;
 	audio2::GainRef				mGain;
 	audio2::Pan2dRef			mPan;
+	audio2::SamplerRef			mSampler;
 
 	WaveformPlot				mWaveformPlot;
 	vector<TestWidget *>		mWidgets;
 	Button						mEnableGraphButton, mStartPlaybackButton, mLoopButton, mAsyncButton;
 	VSelector					mTestSelector;
-	HSlider						mGainSlider, mPanSlider, mLoopBeginSlider, mLoopEndSlider;
+	HSlider						mGainSlider, mPanSlider, mLoopBeginSlider, mLoopEndSlider, mRateSlider;
 
 	Anim<float>					mUnderrunFade, mOverrunFade;
 	Rectf						mUnderrunRect, mOverrunRect;
 	bool						mSamplePlayerEnabledState;
+	uint32_t					mLastSamplerVoiceId;
+	size_t						mNumActiveSamplerVoices;
 	std::future<void>			mAsyncLoadFuture;
 };
 
@@ -97,6 +106,7 @@ void SamplePlayerTestApp::setup()
 
 	setupBufferPlayer();
 //	setupFilePlayer();
+	setupSampler();
 
 	setupUI();
 
@@ -178,6 +188,17 @@ void SamplePlayerTestApp::setupFilePlayer()
 	audio2::master()->printGraph();
 }
 
+// The Sampler plays alongside mSamplePlayer, straight to the output. Keys: t = trigger, r = release last voice, a = release all, v = voice stealing test.
+void SamplePlayerTestApp::setupSampler()
+{
+	auto format = audio2::Sampler::Format().numVoices( 8 ).stealMode( audio2::Sampler::StealMode::LOWEST_PRIORITY );
+	mSampler = audio2::master()->makeNode( new audio2::Sampler( mSourceFile->loadBuffer(), format ) );
+	mSampler >> audio2::master()->getOutput();
+
+	mLastSamplerVoiceId = 0;
+	mNumActiveSamplerVoices = 0;
+}
+
 void SamplePlayerTestApp::setSourceFile( const DataSourceRef &dataSource )
 {
 	mSourceFile = audio2::load( dataSource );
@@ -261,6 +282,13 @@ void SamplePlayerTestApp::setupUI()
 	mLoopEndSlider.set( mSamplePlayer->getLoopEndTime() );
 	mWidgets.push_back( &mLoopEndSlider );
 
+	sliderRect += Vec2f( 0.0f, sliderRect.getHeight() + padding );
+	mRateSlider.mBounds = sliderRect;
+	mRateSlider.mTitle = "Rate (BufferPlayer)";
+	mRateSlider.mMax = 2.0f;
+	mRateSlider.set( 1.0f );
+	mWidgets.push_back( &mRateSlider );
+
 	Vec2f xrunSize( 80.0f, 26.0f );
 	mUnderrunRect = Rectf( padding, getWindowHeight() - xrunSize.y - padding, xrunSize.x + padding, getWindowHeight() - padding );
 	mOverrunRect = mUnderrunRect + Vec2f( xrunSize.x + padding, 0.0f );
@@ -286,6 +314,11 @@ void SamplePlayerTestApp::processDrag( Vec2i pos )
 		mSamplePlayer->setLoopBeginTime( mLoopBeginSlider.mValueScaled );
 	else if( mLoopEndSlider.hitTest( pos ) )
 		mSamplePlayer->setLoopEndTime( mLoopEndSlider.mValueScaled );
+	else if( mRateSlider.hitTest( pos ) ) {
+		auto bufferPlayer = dynamic_pointer_cast<audio2::BufferPlayer>( mSamplePlayer );
+		if( bufferPlayer )
+			bufferPlayer->setRate( mRateSlider.mValueScaled );
+	}
 	else if( pos.y > getWindowCenter().y )
 		seek( pos.x );
 }
@@ -320,6 +353,44 @@ void SamplePlayerTestApp::seek( size_t xPos )
 	mSamplePlayer->seek( mSamplePlayer->getNumFrames() * xPos / getWindowWidth() );
 }
 
+// Key l: loops the half second from the read position, so that the loop wraps often enough to hear any gap or click at the loop point.
+void SamplePlayerTestApp::setShortLoop()
+{
+	const size_t loopFrames = mSamplePlayer->getSampleRate() / 2;
+	const size_t numFrames = mSamplePlayer->getNumFrames();
+	const size_t loopBegin = min( mSamplePlayer->getReadPosition(), numFrames > loopFrames ? numFrames - loopFrames : 0 );
+
+	// end first, so that the new begin isn't clamped to the old end
+	mSamplePlayer->setLoopEnd( loopBegin + loopFrames );
+	mSamplePlayer->setLoopBegin( loopBegin );
+	mSamplePlayer->setLoopEnabled();
+
+	mLoopButton.setEnabled( true );
+	mLoopBeginSlider.set( (float)mSamplePlayer->getLoopBeginTime() );
+	mLoopEndSlider.set( (float)mSamplePlayer->getLoopEndTime() );
+
+	CI_LOG_V( "looping frames [" << mSamplePlayer->getLoopBegin() << ", " << mSamplePlayer->getLoopEnd() << ")" );
+}
+
+// FilePlayer cue points. Keys: u = add one at the read position, n = seek to the next one (wrapping around), x = clear all.
+// Seeking to one should play from its pre-roll without the underrun indicator lighting up.
+void SamplePlayerTestApp::seekToNextCuePoint()
+{
+	auto filePlayer = dynamic_pointer_cast<audio2::FilePlayer>( mSamplePlayer );
+	if( ! filePlayer )
+		return;
+
+	auto cuePoints = filePlayer->getCuePoints();
+	if( cuePoints.empty() )
+		return;
+
+	auto it = upper_bound( cuePoints.begin(), cuePoints.end(), filePlayer->getReadPosition() );
+	size_t position = it != cuePoints.end() ? *it : cuePoints.front();
+
+	CI_LOG_V( "seeking to cue point at frame: " << position );
+	filePlayer->seek( position );
+}
+
 void SamplePlayerTestApp::printBufferSamples( size_t xPos )
 {
 	auto bufferPlayer = dynamic_pointer_cast<audio2::BufferPlayer>( mSamplePlayer );
@@ -353,6 +424,37 @@ void SamplePlayerTestApp::keyDown( KeyEvent event )
 		testWrite();
 	if( event.getCode() == KeyEvent::KEY_s )
 		mSamplePlayer->seekToTime( 1.0 );
+	if( event.getCode() == KeyEvent::KEY_l )
+		setShortLoop();
+	if( event.getCode() == KeyEvent::KEY_n )
+		seekToNextCuePoint();
+
+	auto filePlayer = dynamic_pointer_cast<audio2::FilePlayer>( mSamplePlayer );
+	if( filePlayer && event.getCode() == KeyEvent::KEY_u ) {
+		filePlayer->addCuePoint( filePlayer->getReadPosition() );
+		CI_LOG_V( "added cue point at frame: " << filePlayer->getReadPosition() << ", num cue points: " << filePlayer->getCuePoints().size() );
+	}
+	if( filePlayer && event.getCode() == KeyEvent::KEY_x )
+		filePlayer->clearCuePoints();
+	if( event.getCode() == KeyEvent::KEY_t ) {
+		mLastSamplerVoiceId = mSampler->trigger( 0.5f, randFloat(), randFloat( 0.5f, 2.0f ) );
+		CI_LOG_V( "triggered sampler voice: " << mLastSamplerVoiceId );
+	}
+	if( event.getCode() == KeyEvent::KEY_r )
+		mSampler->release( mLastSamplerVoiceId );
+	if( event.getCode() == KeyEvent::KEY_a )
+		mSampler->releaseAll();
+	if( event.getCode() == KeyEvent::KEY_v )
+		testSamplerVoiceStealing();
+	if( event.getCode() == KeyEvent::KEY_i ) {
+		auto bufferPlayer = dynamic_pointer_cast<audio2::BufferPlayer>( mSamplePlayer );
+		if( bufferPlayer ) {
+			// cycle through LINEAR, CUBIC and SINC
+			auto interpolation = audio2::BufferPlayer::Interpolation( ( (int)bufferPlayer->getInterpolation() + 1 ) % 3 );
+			bufferPlayer->setInterpolation( interpolation );
+			CI_LOG_V( "interpolation: " << (int)interpolation );
+		}
+	}
 }
 
 void SamplePlayerTestApp::fileDrop( FileDropEvent event )
@@ -377,6 +479,8 @@ void SamplePlayerTestApp::fileDrop( FileDropEvent event )
 		filePlayer->setSourceFile( mSourceFile );
 	}
 
+	mSampler->setBuffer( mSourceFile->loadBuffer() );
+
 	mLoopBeginSlider.mMax = mLoopEndSlider.mMax = mSamplePlayer->getNumSeconds();
 
 	CI_LOG_V( "loaded and set new source buffer, channels: " << mSourceFile->getNumChannels() << ", frames: " << mSourceFile->getNumFrames() );
@@ -396,6 +500,12 @@ void SamplePlayerTestApp::update()
 			timeline().apply( &mOverrunFade, 1.0f, 0.0f, xrunFadeTime );
 	}
 
+	// the Sampler reports the number of playing voices as of the last processed block
+	if( mNumActiveSamplerVoices != mSampler->getNumActiveVoices() ) {
+		mNumActiveSamplerVoices = mSampler->getNumActiveVoices();
+		CI_LOG_V( "active sampler voices: " << mNumActiveSamplerVoices );
+	}
+
 	// print SamplePlayer start / stop times
 	if( mSamplePlayerEnabledState != mSamplePlayer->isEnabled() ) {
 		mSamplePlayerEnabledState = mSamplePlayer->isEnabled();
@@ -414,6 +524,23 @@ void SamplePlayerTestApp::draw()
 	else if( mScope && mScope->isInitialized() )
 		drawAudioBuffer( mScope->getBuffer(), getWindowBounds() );
 
+	// shade the loop region
+	if( mSamplePlayer->isLoopEnabled() ) {
+		float loopBegin = (float)getWindowWidth() * mSamplePlayer->getLoopBegin() / mSamplePlayer->getNumFrames();
+		float loopEnd = (float)getWindowWidth() * mSamplePlayer->getLoopEnd() / mSamplePlayer->getNumFrames();
+		gl::color( ColorA( 0, 0.5f, 1, 0.2f ) );
+		gl::drawSolidRect( Rectf( loopBegin, 0, loopEnd, (float)getWindowHeight() ) );
+	}
+
+	auto filePlayer = dynamic_pointer_cast<audio2::FilePlayer>( mSamplePlayer );
+	if( filePlayer ) {
+		gl::color( ColorA( 1, 1, 0, 0.7f ) );
+		for( size_t cuePoint : filePlayer->getCuePoints() ) {
+			float x = (float)getWindowWidth() * cuePoint / mSamplePlayer->getNumFrames();
+			gl::drawLine( Vec2f( x, 0 ), Vec2f( x, (float)getWindowHeight() ) );
+		}
+	}
+
 	float readPos = (float)getWindowWidth() * mSamplePlayer->getReadPosition() / mSamplePlayer->getNumFrames();
 	gl::color( ColorA( 0, 1, 0, 0.7f ) );
 	gl::drawSolidRoundedRect( Rectf( readPos - 2, 0, readPos + 2, (float)getWindowHeight() ), 2 );
@@ -493,4 +620,17 @@ void SamplePlayerTestApp::testWrite()
 //	}
 }
 
+// Triggers twice as many voices as the Sampler has, with rising priority. With StealMode::LOWEST_PRIORITY, each of the second half steals one
+// of the first, so the active voice count should stay at getNumVoices(). A final trigger with the lowest priority is dropped.
+void SamplePlayerTestApp::testSamplerVoiceStealing()
+{
+	const size_t numVoices = mSampler->getNumVoices();
+	CI_LOG_V( "triggering " << numVoices * 2 << " voices, expecting " << numVoices << " active." );
+
+	for( size_t i = 0; i < numVoices * 2; i++ )
+		mSampler->trigger( 0.2f, float( i ) / float( numVoices * 2 ), 1, (int)i );
+
+	mSampler->trigger( 0.2f, 0.5f, 1, -1 );
+}
+
 CINDER_APP_NATIVE( SamplePlayerTestApp, RendererGl )
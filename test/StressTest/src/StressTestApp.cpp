@@ -19,7 +19,7 @@ using namespace ci;
 using namespace ci::app;
 using namespace std;
 
-enum GenType { SINE, TRIANGLE, OSC_SINE, OSC_SAW, OSC_SQUARE, OSC_TRIANGLE };
+enum GenType { SINE, TRIANGLE, OSC_SINE, OSC_SAW, OSC_SQUARE, OSC_TRIANGLE, BANK };
 
 class StressTestApp : public AppNative {
 public:
@@ -35,14 +35,16 @@ public:
 	void addGens();
 	void removeGens();
 	void clearGens();
+	void addBankOscillators();
+	void removeBankOscillators();
 
 	audio2::GenRef	makeSelectedGenType();
 	audio2::GenRef	makeOsc( audio2::WaveformType type );
 
 	audio2::GainRef				mGain;
 	audio2::ScopeSpectralRef	mScope;
-	audio2::dsp::WaveTable2dRef	mWaveTable;
 	vector<audio2::GenRef>		mGenBank;
+	audio2::GenBankRef			mOscBank;
 
 	vector<TestWidget *>	mWidgets;
 	Button					mPlayButton, mAddGens, mRemoveGens, mClearGens;
@@ -52,7 +54,7 @@ public:
 	SpectrumPlot			mSpectrumPlot;
 
 	bool					mEnableDrawing;
-	size_t					mAddIncr;
+	size_t					mAddIncr, mNumBankOscillators;
 	GenType					mSelectedGenType;
 };
 
@@ -64,6 +66,7 @@ void StressTestApp::prepareSettings( Settings *settings )
 void StressTestApp::setup()
 {
 	mAddIncr = 1;
+	mNumBankOscillators = 0;
 	mEnableDrawing = true;
 	mSelectedGenType = OSC_SQUARE;
 
@@ -76,6 +79,11 @@ void StressTestApp::setup()
 
 	mGain >> mScope >> ctx->getOutput();
 
+	// all oscillators in the bank are rendered by one Node, 'adding' them only ramps up their gain
+	mOscBank = ctx->makeNode( new audio2::GenBank( 4096 ) );
+	mOscBank->addConnection( mGain );
+	mOscBank->start();
+
 	addGens();
 
 	setupUI();
@@ -84,6 +92,11 @@ void StressTestApp::setup()
 
 void StressTestApp::addGens()
 {
+	if( mSelectedGenType == BANK ) {
+		addBankOscillators();
+		return;
+	}
+
 	auto ctx = audio2::master();
 
 	for( size_t i = 0; i < mAddIncr; i++ ) {
@@ -102,6 +115,11 @@ void StressTestApp::addGens()
 
 void StressTestApp::removeGens()
 {
+	if( mSelectedGenType == BANK ) {
+		removeBankOscillators();
+		return;
+	}
+
 	for( size_t i = 0; i < mAddIncr; i++ ) {
 		mGenBank.back()->disconnectAll();
 		mGenBank.pop_back();
@@ -113,6 +131,9 @@ void StressTestApp::removeGens()
 
 void StressTestApp::clearGens()
 {
+	while( mNumBankOscillators )
+		mOscBank->setGain( --mNumBankOscillators, 0, 0.05f );
+
 	while( ! mGenBank.empty() ) {
 		mGenBank.back()->disconnectAll();
 		mGenBank.pop_back();
@@ -122,6 +143,25 @@ void StressTestApp::clearGens()
 	CI_LOG_V( "gen count: " << mGenBank.size() );
 }
 
+void StressTestApp::addBankOscillators()
+{
+	for( size_t i = 0; i < mAddIncr && mNumBankOscillators < mOscBank->getNumOscillators(); i++ ) {
+		mOscBank->setFreq( mNumBankOscillators, audio2::toFreq( randInt( 40, 60 ) ) );
+		mOscBank->setGain( mNumBankOscillators, 1, 0.05f );
+		mNumBankOscillators++;
+	}
+
+	CI_LOG_V( "bank oscillator count: " << mNumBankOscillators );
+}
+
+void StressTestApp::removeBankOscillators()
+{
+	for( size_t i = 0; i < mAddIncr && mNumBankOscillators; i++ )
+		mOscBank->setGain( --mNumBankOscillators, 0, 0.05f );
+
+	CI_LOG_V( "bank oscillator count: " << mNumBankOscillators );
+}
+
 audio2::GenRef StressTestApp::makeSelectedGenType()
 {
 	switch( mSelectedGenType ) {
@@ -140,18 +180,8 @@ audio2::GenRef StressTestApp::makeSelectedGenType()
 
 audio2::GenRef StressTestApp::makeOsc( audio2::WaveformType type )
 {
-	auto ctx = audio2::master();
-	auto result = ctx->makeNode( new audio2::GenOscillator( audio2::GenOscillator::Format().waveform( type ) ) );
-
-	if( mWaveTable )
-		result->setWaveTable( mWaveTable );
-	else {
-		ctx->initializeNode( result );
-
-		mWaveTable = result->getWaveTable();
-	}
-
-	return result;
+	// oscillators of the same waveform share one table set through dsp::WaveTableCache
+	return audio2::master()->makeNode( new audio2::GenOscillator( audio2::GenOscillator::Format().waveform( type ) ) );
 }
 
 void StressTestApp::setupUI()
@@ -183,7 +213,8 @@ void StressTestApp::setupUI()
 	mTestSelector.mSegments.push_back( "osc sawtooth" );
 	mTestSelector.mSegments.push_back( "osc square" );
 	mTestSelector.mSegments.push_back( "osc triangle" );
-	mTestSelector.mBounds = Rectf( (float)getWindowWidth() - 200, buttonRect.y2 + 10, (float)getWindowWidth(), buttonRect.y2 + 190 );
+	mTestSelector.mSegments.push_back( "bank" );
+	mTestSelector.mBounds = Rectf( (float)getWindowWidth() - 200, buttonRect.y2 + 10, (float)getWindowWidth(), buttonRect.y2 + 220 );
 	mWidgets.push_back( &mTestSelector );
 
 	Rectf sliderRect = mTestSelector.mBounds;
@@ -245,22 +276,16 @@ void StressTestApp::processTap( Vec2i pos )
 			mSelectedGenType = SINE;
 		else if( currentTest == "triangle" )
 			mSelectedGenType = TRIANGLE;
-		else if( currentTest == "osc sine" ) {
+		else if( currentTest == "osc sine" )
 			mSelectedGenType = OSC_SINE;
-			mWaveTable.reset();
-		}
-		else if( currentTest == "osc sawtooth" ) {
+		else if( currentTest == "osc sawtooth" )
 			mSelectedGenType = OSC_SAW;
-			mWaveTable.reset();
-		}
-		else if( currentTest == "osc square" ) {
+		else if( currentTest == "osc square" )
 			mSelectedGenType = OSC_SQUARE;
-			mWaveTable.reset();
-		}
-		else if( currentTest == "osc triangle" ) {
+		else if( currentTest == "osc triangle" )
 			mSelectedGenType = OSC_TRIANGLE;
-			mWaveTable.reset();
-		}
+		else if( currentTest == "bank" )
+			mSelectedGenType = BANK;
 	}
 	else
 		processDrag( pos );
@@ -313,7 +338,7 @@ void StressTestApp::draw()
 
 	drawWidgets( mWidgets );
 
-	string countStr = string( "Gen count: " ) + to_string( mGenBank.size() );
+	string countStr = string( "Gen count: " ) + to_string( mGenBank.size() ) + ", bank: " + to_string( mNumBankOscillators );
 	getTestWidgetTexFont()->drawString( countStr, Vec2f( mAddIncrInput.mBounds.x1, mAddIncrInput.mBounds.y2 + padding + getTestWidgetTexFont()->getFont().getAscent() + getTestWidgetTexFont()->getFont().getDescent() ) );
 }
 
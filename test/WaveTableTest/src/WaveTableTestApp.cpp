@@ -32,11 +32,12 @@ public:
 	void setupTable();
 	void setupOsc( audio2::WaveformType type );
 	void setupPulse();
+	void setupPolyBlep( audio2::WaveformType type );
 	void setupTriangleCalc();
 
 	audio2::GainRef				mGain;
 	audio2::ScopeSpectralRef	mScope;
-	audio2::GenOscillatorRef	mGenOsc;
+	audio2::GenOscillatorRef	mGenOsc, mGenPolyBlep;
 	audio2::GenPulseRef			mGenPulse;
 	audio2::GenRef				mGen;
 
@@ -141,6 +142,21 @@ void WaveTableTestApp::setupPulse()
 	audio2::master()->printGraph();
 }
 
+// for comparison with the wavetable spectra, the pulse width slider controls the square's width
+void WaveTableTestApp::setupPolyBlep( audio2::WaveformType type )
+{
+	if( ! mGenPolyBlep ) {
+		auto format = audio2::GenOscillator::Format().waveform( type ).bandlimitMode( audio2::GenOscillator::BandlimitMode::POLY_BLEP );
+		mGenPolyBlep = audio2::master()->makeNode( new audio2::GenOscillator( format ) );
+		mGenPolyBlep->setFreq( mFreqSlider.mValueScaled );
+		mGenPolyBlep->start();
+	}
+	else
+		mGenPolyBlep->setWaveform( type );
+
+	mGen = mGenPolyBlep;
+}
+
 // for comparison with GenOscillator's triangle spectra
 void WaveTableTestApp::setupTriangleCalc()
 {
@@ -167,7 +183,10 @@ void WaveTableTestApp::setupUI()
 	mTestSelector.mSegments.push_back( "pulse" );
 	mTestSelector.mSegments.push_back( "sine (table)" );
 	mTestSelector.mSegments.push_back( "triangle (calc)" );
-	mTestSelector.mBounds = Rectf( (float)getWindowWidth() - 200, buttonRect.y2 + 10, (float)getWindowWidth(), buttonRect.y2 + 190 );
+	mTestSelector.mSegments.push_back( "square (polyblep)" );
+	mTestSelector.mSegments.push_back( "sawtooth (polyblep)" );
+	mTestSelector.mSegments.push_back( "triangle (polyblep)" );
+	mTestSelector.mBounds = Rectf( (float)getWindowWidth() - 200, buttonRect.y2 + 10, (float)getWindowWidth(), buttonRect.y2 + 270 );
 	mWidgets.push_back( &mTestSelector );
 
 	// freq slider is longer, along top
@@ -243,6 +262,8 @@ void WaveTableTestApp::processDrag( Vec2i pos )
 //		mGenPulse->setWidth( mPulseWidthSlider.mValueScaled );
 		mGenPulse->getParamWidth()->applyRamp( mPulseWidthSlider.mValueScaled, 0.5f );
 	}
+	else if( mGenPolyBlep && mPulseWidthSlider.hitTest( pos ) )
+		mGenPolyBlep->getParamWidth()->applyRamp( mPulseWidthSlider.mValueScaled, 0.5f );
 
 }
 
@@ -277,6 +298,12 @@ void WaveTableTestApp::processTap( Vec2i pos )
 			setupTable();
 		else if( currentTest == "triangle (calc)" )
 			setupTriangleCalc();
+		else if( currentTest == "square (polyblep)" )
+			setupPolyBlep( audio2::WaveformType::SQUARE );
+		else if( currentTest == "sawtooth (polyblep)" )
+			setupPolyBlep( audio2::WaveformType::SAWTOOTH );
+		else if( currentTest == "triangle (polyblep)" )
+			setupPolyBlep( audio2::WaveformType::TRIANGLE );
 
 		mGen >> mScope;
 	}
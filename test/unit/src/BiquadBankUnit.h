@@ -0,0 +1,80 @@
+#pragma once
+
+#include "utils.h"
+#include "cinder/audio2/dsp/Biquad.h"
+#include "cinder/audio2/dsp/BiquadBank.h"
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+BOOST_AUTO_TEST_SUITE( test_biquad_bank )
+
+using namespace ci::audio2;
+
+namespace {
+
+// not a multiple of the lane count, so the last group is partially filled
+const size_t kNumFilters = 7;
+const size_t kNumFrames = 1023;
+
+// Filters noise with both a bank of differently tuned lowpass filters and the same number of scalar dsp::Biquad's, returning the largest difference.
+// The bank is processed in two calls through the pointer interface, to verify state is carried over between blocks.
+float compareBankToBiquads( dsp::BiquadBank::Precision precision )
+{
+	Buffer input( kNumFrames, kNumFilters );
+	for( size_t i = 0; i < input.getSize(); i++ )
+		input[i] = float( std::rand() ) / float( RAND_MAX ) * 2 - 1;
+
+	Buffer expected( kNumFrames, kNumFilters );
+	Buffer actual( kNumFrames, kNumFilters );
+
+	dsp::BiquadBank bank( kNumFilters, precision );
+	for( size_t i = 0; i < kNumFilters; i++ ) {
+		dsp::Biquad biquad;
+		biquad.setLowpassParams( 0.01 + 0.1 * i, 3.0 );
+		biquad.process( input.getChannel( i ), expected.getChannel( i ), kNumFrames );
+		bank.setCoefficients( i, biquad );
+	}
+
+	const size_t split = 500;
+	const float *sources[kNumFilters];
+	float *dests[kNumFilters];
+	for( size_t i = 0; i < kNumFilters; i++ ) {
+		sources[i] = input.getChannel( i );
+		dests[i] = actual.getChannel( i );
+	}
+
+	bank.process( sources, dests, split );
+
+	for( size_t i = 0; i < kNumFilters; i++ ) {
+		sources[i] += split;
+		dests[i] += split;
+	}
+
+	bank.process( sources, dests, kNumFrames - split );
+
+	float maxErr = 0;
+	for( size_t i = 0; i < expected.getSize(); i++ )
+		maxErr = std::max( maxErr, std::fabs( expected[i] - actual[i] ) );
+
+	return maxErr;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE( test_float_state )
+{
+	float maxErr = compareBankToBiquads( dsp::BiquadBank::FLOAT );
+	std::cout << "\tBiquadBank (float) max error: " << maxErr << std::endl;
+	BOOST_CHECK( maxErr < 1e-4f );
+}
+
+BOOST_AUTO_TEST_CASE( test_double_state )
+{
+	float maxErr = compareBankToBiquads( dsp::BiquadBank::DOUBLE );
+	std::cout << "\tBiquadBank (double) max error: " << maxErr << std::endl;
+	BOOST_CHECK( maxErr < 1e-6f );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
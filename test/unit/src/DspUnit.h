@@ -0,0 +1,106 @@
+#pragma once
+
+#include "utils.h"
+#include "cinder/audio2/dsp/Dsp.h"
+
+#include <iostream>
+#include <cmath>
+
+BOOST_AUTO_TEST_SUITE( test_dsp )
+
+using namespace ci::audio2;
+
+BOOST_AUTO_TEST_CASE( test_ramp )
+{
+	// long enough that a naively accumulated ramp would drift well beyond the acceptable error
+	const size_t length = 1 << 20;
+	const double begin = 0.1, incr = (float)( 0.7 / length );
+	Buffer buffer( length );
+
+	dsp::ramp( buffer.getData(), length, (float)begin, (float)incr );
+
+	float maxErr = 0;
+	for( size_t i = 0; i < length; i++ )
+		maxErr = std::max( maxErr, (float)std::fabs( buffer[i] - ( begin + i * incr ) ) );
+
+	std::cout << "\tdsp::ramp max error: " << maxErr << std::endl;
+	BOOST_CHECK( maxErr < 1e-6f );
+}
+
+BOOST_AUTO_TEST_CASE( test_ramp_geometric )
+{
+	const size_t length = 1 << 20;
+	const double begin = 0.001, end = 1.0;
+	const double ratio = std::pow( end / begin, 1.0 / length );
+	Buffer buffer( length );
+
+	dsp::rampGeometric( buffer.getData(), length, (float)begin, (float)ratio );
+
+	// relative error, since the values span several orders of magnitude
+	float maxErr = 0;
+	for( size_t i = 0; i < length; i++ ) {
+		double expected = begin * std::pow( (double)(float)ratio, (double)i );
+		maxErr = std::max( maxErr, (float)std::fabs( ( buffer[i] - expected ) / expected ) );
+	}
+
+	std::cout << "\tdsp::rampGeometric max relative error: " << maxErr << std::endl;
+	BOOST_CHECK( maxErr < 1e-5f );
+}
+
+// phases and increments are multiples of 2^-24 cycles, which are exact in float as well as in dsp::sine()'s fixed point phase, so the
+// expected values (computed in double precision) don't drift and the error is only that of the polynomial approximation
+BOOST_AUTO_TEST_CASE( test_sine )
+{
+	const size_t length = 1 << 16;
+	const double quantize = 1 << 24;
+	const float beginPhase = 0.3f;
+	Buffer buffer( length );
+
+	float maxErr = 0, maxPhaseErr = 0;
+	for( double incr : { 441.0 / 44100.0, 0.25, 0.4999, 1e-4, -0.013 } ) {
+		incr = std::round( incr * quantize ) / quantize;
+
+		float endPhase = dsp::sine( buffer.getData(), length, beginPhase, (float)incr );
+
+		for( size_t i = 0; i < length; i++ )
+			maxErr = std::max( maxErr, (float)std::fabs( buffer[i] - std::sin( 2 * M_PI * ( beginPhase + i * incr ) ) ) );
+
+		double expectedEndPhase = beginPhase + length * incr;
+		maxPhaseErr = std::max( maxPhaseErr, (float)std::fabs( endPhase - ( expectedEndPhase - std::floor( expectedEndPhase ) ) ) );
+	}
+
+	std::cout << "\tdsp::sine max error: " << maxErr << ", end phase error: " << maxPhaseErr << std::endl;
+	BOOST_CHECK( maxErr < 5e-7f );
+	BOOST_CHECK( maxPhaseErr < 1e-6f );
+}
+
+BOOST_AUTO_TEST_CASE( test_sine_varying )
+{
+	const size_t length = 1 << 16;
+	const double quantize = 1 << 24;
+	Buffer incrBuffer( length ), buffer( length );
+
+	// a slow sweep from 20hz to 20khz at 44.1khz, including increments beyond 1/2 cycle, which alias the same as they would with sin()
+	for( size_t i = 0; i < length; i++ )
+		incrBuffer[i] = (float)( std::round( ( 20.0 + 20000.0 * i / length ) / 44100.0 * ( i % 7 == 0 ? 3 : 1 ) * quantize ) / quantize );
+
+	float endPhase = dsp::sine( buffer.getData(), length, 0, incrBuffer.getData() );
+
+	float maxErr = 0;
+	double phase = 0;
+	for( size_t i = 0; i < length; i++ ) {
+		maxErr = std::max( maxErr, (float)std::fabs( buffer[i] - std::sin( 2 * M_PI * phase ) ) );
+		phase += incrBuffer[i];
+		phase -= std::floor( phase );
+	}
+
+	// also computed in place, as GenSine does
+	dsp::sine( incrBuffer.getData(), length, 0, incrBuffer.getData() );
+
+	std::cout << "\tdsp::sine (varying) max error: " << maxErr << std::endl;
+	BOOST_CHECK( maxErr < 5e-7f );
+	BOOST_CHECK_SMALL( endPhase - (float)phase, 1e-6f );
+	BOOST_CHECK_EQUAL_COLLECTIONS( incrBuffer.getData(), incrBuffer.getData() + length, buffer.getData(), buffer.getData() + length );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
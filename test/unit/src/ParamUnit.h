@@ -0,0 +1,73 @@
+#pragma once
+
+#include "utils.h"
+#include "cinder/audio2/Context.h"
+#include "cinder/audio2/NodeEffect.h"
+#include "cinder/audio2/NodeOutput.h"
+
+BOOST_AUTO_TEST_SUITE( test_param )
+
+using namespace std;
+using namespace ci::audio2;
+
+namespace {
+
+// Output with a fixed samplerate and block size that is never started, so Param's can be evaluated without an audio device.
+// The Context's processed frame count stays at 0.
+class OutputFixed : public NodeOutput {
+  public:
+	OutputFixed( size_t sampleRate, size_t framesPerBlock ) : mSampleRate( sampleRate ), mFramesPerBlock( framesPerBlock ) {}
+
+	size_t getOutputSampleRate() override		{ return mSampleRate; }
+	size_t getOutputFramesPerBlock() override	{ return mFramesPerBlock; }
+
+  private:
+	size_t mSampleRate, mFramesPerBlock;
+};
+
+class ContextFixed : public Context {
+  public:
+	LineOutRef	createLineOut( const DeviceRef &device, const Node::Format &format ) override	{ return LineOutRef(); }
+	LineInRef	createLineIn( const DeviceRef &device, const Node::Format &format ) override	{ return LineInRef(); }
+};
+
+} // anonymous namespace
+
+// At EvalRate::CONTROL with a period that doesn't divide the block, the last control point lies past the end of the block. A ramp that ends
+// in between must still fill that point with its end value.
+BOOST_AUTO_TEST_CASE( test_control_rate_non_dividing_period )
+{
+	const size_t sampleRate = 44100;
+	const size_t framesPerBlock = 512;
+	const size_t controlPeriod = 48; // 12 control points, the last at frame 528
+
+	auto ctx = make_shared<ContextFixed>();
+	ctx->setOutput( ctx->makeNode( new OutputFixed( sampleRate, framesPerBlock ) ) );
+
+	auto gain = ctx->makeNode( new Gain( 1.0f ) );
+	Param *param = gain->getParam();
+	param->setEvalRate( Param::EvalRate::CONTROL, true );
+	param->setControlPeriod( controlPeriod );
+
+	// ends at frame 520
+	param->applyRamp( 1, 2, 520.5f / float( sampleRate ) );
+
+	BOOST_REQUIRE( param->eval() );
+
+	const size_t numControlValues = param->getNumControlValues();
+	const float *controlValues = param->getControlValueArray();
+	BOOST_REQUIRE_EQUAL( numControlValues, 12 );
+	BOOST_CHECK_EQUAL( controlValues[numControlValues - 1], 2.0f );
+
+	const float *values = param->getValueArray();
+	for( size_t i = 0; i < framesPerBlock; i++ ) {
+		BOOST_CHECK( values[i] >= 1.0f && values[i] <= 2.0f );
+		if( i > 0 )
+			BOOST_CHECK( values[i] >= values[i - 1] );
+	}
+
+	// the last point rendered from the ramp, at frame 480
+	BOOST_CHECK_CLOSE( param->getValue(), 1.0f + 480.0f / 520.0f, 0.01f );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
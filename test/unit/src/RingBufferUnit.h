@@ -74,4 +74,78 @@ BOOST_AUTO_TEST_CASE( test_threaded_stress )
 	cout << "writer joined." << endl;
 }
 
+BOOST_AUTO_TEST_CASE( test_multichannel_wrap )
+{
+	const size_t kNumChannels = 3;
+	dsp::MultiChannelRingBufferT<int> rb( 10, kNumChannels );
+	BufferT<int> a( 7, kNumChannels ), b( 7, kNumChannels );
+
+	int currValue = 0;
+	for( size_t pass = 0; pass < 5; pass++ ) {
+		for( size_t ch = 0; ch < kNumChannels; ch++ ) {
+			for( size_t i = 0; i < a.getNumFrames(); i++ )
+				a.getChannel( ch )[i] = currValue + i + ch * 1000;
+		}
+
+		BOOST_REQUIRE( rb.write( a, a.getNumFrames() ) );
+		BOOST_REQUIRE( rb.read( &b, b.getNumFrames() ) );
+
+		for( size_t ch = 0; ch < kNumChannels; ch++ ) {
+			for( size_t i = 0; i < b.getNumFrames(); i++ )
+				BOOST_CHECK_EQUAL( b.getChannel( ch )[i], currValue + i + ch * 1000 );
+		}
+
+		currValue += a.getNumFrames();
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_multichannel_all_or_nothing )
+{
+	dsp::MultiChannelRingBufferT<int> rb( 10, 2 );
+	BufferT<int> a( 8, 2 ), b( 9, 2 );
+
+	BOOST_REQUIRE( rb.write( a, 8 ) );
+	BOOST_CHECK( ! rb.write( a, 3 ) );
+	BOOST_CHECK_EQUAL( rb.getAvailableRead(), 8 );
+
+	BOOST_CHECK( ! rb.read( &b, 9 ) );
+	BOOST_CHECK_EQUAL( rb.getAvailableRead(), 8 );
+
+	rb.clear();
+	BOOST_CHECK_EQUAL( rb.getAvailableRead(), 0 );
+	BOOST_CHECK_EQUAL( rb.getAvailableWrite(), 10 );
+}
+
+// the consumer isn't running, so pushing to a full queue has to drain it under the consumer's mutex first.
+BOOST_AUTO_TEST_CASE( test_command_queue_drain_when_full )
+{
+	dsp::CommandQueueT<int> queue( 4 );
+	mutex consumerMutex;
+	vector<int> consumed;
+	size_t numDrains = 0;
+
+	auto drainFn = [&] {
+		BOOST_CHECK( ! consumerMutex.try_lock() );
+		numDrains++;
+
+		int command;
+		while( queue.pop( &command ) )
+			consumed.push_back( command );
+	};
+
+	for( int i = 0; i < 10; i++ )
+		queue.push( i, consumerMutex, drainFn );
+
+	BOOST_CHECK_EQUAL( numDrains, 2 );
+	BOOST_CHECK_EQUAL( queue.getAvailableRead(), 2 );
+
+	int command;
+	while( queue.pop( &command ) )
+		consumed.push_back( command );
+
+	BOOST_REQUIRE_EQUAL( consumed.size(), 10 );
+	for( int i = 0; i < 10; i++ )
+		BOOST_CHECK_EQUAL( consumed[i], i );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
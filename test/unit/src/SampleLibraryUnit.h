@@ -0,0 +1,245 @@
+#pragma once
+
+#include "utils.h"
+#include "cinder/audio2/SampleLibrary.h"
+#include "cinder/DataSource.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE( test_sample_library )
+
+using namespace std;
+using namespace ci::audio2;
+
+namespace {
+
+// A new directory for cache files, removed along with its contents at the end of the test.
+struct ScopedTempDirectory {
+	ScopedTempDirectory() : mPath( ci::fs::temp_directory_path() / ci::fs::unique_path() )	{ ci::fs::create_directories( mPath ); }
+	~ScopedTempDirectory()	{ boost::system::error_code error; ci::fs::remove_all( mPath, error ); }
+
+	ci::fs::path mPath;
+};
+
+vector<ci::fs::path> listCacheFiles( const ci::fs::path &directory )
+{
+	vector<ci::fs::path> result;
+	for( ci::fs::directory_iterator it( directory ), end; it != end; ++it ) {
+		if( it->path().extension() == ".pcm" )
+			result.push_back( it->path() );
+	}
+
+	return result;
+}
+
+string readFile( const ci::fs::path &path )
+{
+	ifstream stream( path.string().c_str(), ios::binary );
+	return string( istreambuf_iterator<char>( stream ), istreambuf_iterator<char>() );
+}
+
+void writeFile( const ci::fs::path &path, const string &contents )
+{
+	ofstream stream( path.string().c_str(), ios::binary );
+	stream.write( contents.data(), contents.size() );
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE( test_same_path_spelled_differently )
+{
+	SampleLibrary library;
+
+	BufferRef a = library.load( ci::loadFile( getAssetPath( "tone440.ogg" ) ) );
+	BufferRef b = library.load( ci::loadFile( getAssetPath( "" ) / ".." / "assets" / "tone440.ogg" ) );
+
+	BOOST_REQUIRE( a );
+	BOOST_CHECK( a == b );
+	BOOST_CHECK_EQUAL( library.getNumBytes(), a->getSize() * sizeof( float ) );
+}
+
+// Whichever of preload() and the load() calls gets to the file first decodes it, the rest wait for and share that Buffer.
+BOOST_AUTO_TEST_CASE( test_concurrent_loads_of_same_file )
+{
+	SampleLibrary library;
+	auto dataSource = ci::loadFile( getAssetPath( "tone440L220R.ogg" ) );
+
+	mutex preloadMutex;
+	condition_variable preloadCondition;
+	bool preloaded = false;
+	library.preload( { dataSource }, [&]( size_t numFinished, size_t numTotal ) {
+		lock_guard<mutex> lock( preloadMutex );
+		preloaded = true;
+		preloadCondition.notify_all();
+	} );
+
+	const size_t numThreads = 4;
+	vector<BufferRef> buffers( numThreads );
+	vector<thread> threads;
+	for( size_t i = 0; i < numThreads; i++ )
+		threads.emplace_back( [&, i] { buffers[i] = library.load( ci::loadFile( getAssetPath( "tone440L220R.ogg" ) ) ); } );
+
+	for( auto &t : threads )
+		t.join();
+
+	{
+		unique_lock<mutex> lock( preloadMutex );
+		preloadCondition.wait( lock, [&] { return preloaded; } );
+	}
+
+	BOOST_REQUIRE( buffers[0] );
+	for( size_t i = 1; i < numThreads; i++ )
+		BOOST_CHECK( buffers[i] == buffers[0] );
+
+	BOOST_CHECK( library.get( dataSource ) == buffers[0] );
+	BOOST_CHECK_EQUAL( library.getNumBytes(), buffers[0]->getSize() * sizeof( float ) );
+}
+
+// The three keys all decode to the same mono 44.1k Buffer size, and the budget holds two of them.
+BOOST_AUTO_TEST_CASE( test_evicts_least_recently_used )
+{
+	auto dataSource = ci::loadFile( getAssetPath( "tone440.ogg" ) );
+
+	SampleLibrary library;
+	BufferRef a = library.load( dataSource );
+	const size_t numBytes = a->getSize() * sizeof( float );
+	library.setMemoryBudget( numBytes * 2 );
+
+	library.load( dataSource, 44100 );
+	library.get( dataSource ); // a is now the most recently used
+	library.load( dataSource, 0, 1 );
+
+	BOOST_CHECK( library.isLoaded( dataSource ) );
+	BOOST_CHECK( ! library.isLoaded( dataSource, 44100 ) );
+	BOOST_CHECK( library.isLoaded( dataSource, 0, 1 ) );
+	BOOST_CHECK_EQUAL( library.getNumBytes(), numBytes * 2 );
+
+	// evicted Buffer's that are still referenced stay valid
+	BOOST_CHECK_EQUAL( a->getNumFrames(), 176400 );
+
+	library.setMemoryBudget( numBytes );
+	BOOST_CHECK( ! library.isLoaded( dataSource ) );
+	BOOST_CHECK_EQUAL( library.getNumBytes(), numBytes );
+}
+
+BOOST_AUTO_TEST_CASE( test_remove_during_load )
+{
+	SampleLibrary library;
+	auto dataSource = ci::loadFile( getAssetPath( "Stevie Wonder  For Once In My Life.ogg" ) );
+
+	BufferRef buffer;
+	thread loadThread( [&] { buffer = library.load( dataSource ); } );
+
+	// decoding the 45 second file takes far longer than this, so the load is still in progress when it is removed
+	this_thread::sleep_for( chrono::milliseconds( 20 ) );
+	BOOST_CHECK( ! library.isLoaded( dataSource ) );
+	library.remove( dataSource );
+
+	loadThread.join();
+
+	BOOST_REQUIRE( buffer );
+	BOOST_CHECK_EQUAL( buffer->getNumFrames(), 1984206 );
+	BOOST_CHECK( ! library.isLoaded( dataSource ) );
+	BOOST_CHECK_EQUAL( library.getNumBytes(), 0 );
+}
+
+// The second load reads the samples written by the first. The last sample is zeroed in the cache file in between, to tell them apart from decoded ones.
+BOOST_AUTO_TEST_CASE( test_cache_round_trip )
+{
+	const auto sourcePath = getAssetPath( "tone440L220R.ogg" );
+	BufferRef expected = SampleLibrary().load( ci::loadFile( sourcePath ) );
+	const size_t lastChannel = expected->getNumChannels() - 1;
+	const size_t lastFrame = expected->getNumFrames() - 1;
+	BOOST_REQUIRE( expected->getChannel( lastChannel )[lastFrame] != 0 );
+
+	for( auto cacheFormat : { SampleLibrary::CacheFormat::FLOAT32, SampleLibrary::CacheFormat::INT16 } ) {
+		ScopedTempDirectory cacheDir;
+		auto format = SampleLibrary::Format().cacheDirectory( cacheDir.mPath ).cacheFormat( cacheFormat );
+		const size_t sampleSize = cacheFormat == SampleLibrary::CacheFormat::INT16 ? sizeof( int16_t ) : sizeof( float );
+
+		BufferRef decoded = SampleLibrary( format ).load( ci::loadFile( sourcePath ) );
+		BOOST_CHECK_EQUAL( maxError( *decoded, *expected ), 0 );
+
+		auto cacheFiles = listCacheFiles( cacheDir.mPath );
+		BOOST_REQUIRE_EQUAL( cacheFiles.size(), 1 );
+
+		string contents = readFile( cacheFiles[0] );
+		BOOST_REQUIRE( contents.size() > expected->getSize() * sampleSize );
+		contents.replace( contents.size() - sampleSize, sampleSize, sampleSize, '\0' );
+		writeFile( cacheFiles[0], contents );
+
+		BufferRef cached = SampleLibrary( format ).load( ci::loadFile( sourcePath ) );
+		BOOST_REQUIRE_EQUAL( cached->getNumFrames(), expected->getNumFrames() );
+		BOOST_REQUIRE_EQUAL( cached->getNumChannels(), expected->getNumChannels() );
+
+		float &lastSample = cached->getChannel( lastChannel )[lastFrame];
+		BOOST_CHECK_EQUAL( lastSample, 0 );
+		lastSample = expected->getChannel( lastChannel )[lastFrame];
+
+		const float tolerance = cacheFormat == SampleLibrary::CacheFormat::INT16 ? 1.0f / 32767.0f : 0;
+		BOOST_CHECK( maxError( *cached, *expected ) <= tolerance );
+	}
+}
+
+// Changing the source's contents or modification time changes its cache file name. A stale cache file put in place under the new name
+// must still be rejected by its header, replaced and the source decoded again.
+BOOST_AUTO_TEST_CASE( test_cache_rejects_changed_source )
+{
+	ScopedTempDirectory dir;
+	const auto sourcePath = dir.mPath / "source.ogg";
+	const auto cachePath = dir.mPath / "cache";
+	auto format = SampleLibrary::Format().cacheDirectory( cachePath );
+	auto load = [&] { return SampleLibrary( format ).load( ci::loadFile( sourcePath ) ); };
+
+	BufferRef expectedMono = SampleLibrary().load( ci::loadFile( getAssetPath( "tone440.ogg" ) ) );
+
+	writeFile( sourcePath, readFile( getAssetPath( "tone440L220R.ogg" ) ) );
+	const time_t modifiedTime = ci::fs::last_write_time( sourcePath );
+	load();
+
+	auto cacheFiles = listCacheFiles( cachePath );
+	BOOST_REQUIRE_EQUAL( cacheFiles.size(), 1 );
+	const string stereoCache = readFile( cacheFiles[0] );
+
+	// new contents with the same modification time, the superseded cache file is removed
+	writeFile( sourcePath, readFile( getAssetPath( "tone440.ogg" ) ) );
+	ci::fs::last_write_time( sourcePath, modifiedTime );
+
+	BufferRef buffer = load();
+	BOOST_REQUIRE_EQUAL( buffer->getNumChannels(), 1 );
+	BOOST_CHECK_EQUAL( maxError( *buffer, *expectedMono ), 0 );
+
+	cacheFiles = listCacheFiles( cachePath );
+	BOOST_REQUIRE_EQUAL( cacheFiles.size(), 1 );
+	const string monoCache = readFile( cacheFiles[0] );
+
+	// mismatched contents hash
+	writeFile( cacheFiles[0], stereoCache );
+	buffer = load();
+	BOOST_REQUIRE_EQUAL( buffer->getNumChannels(), 1 );
+	BOOST_CHECK_EQUAL( maxError( *buffer, *expectedMono ), 0 );
+	BOOST_CHECK( readFile( cacheFiles[0] ) == monoCache );
+
+	// new modification time with the same contents
+	ci::fs::last_write_time( sourcePath, modifiedTime + 100 );
+	load();
+
+	auto newCacheFiles = listCacheFiles( cachePath );
+	BOOST_REQUIRE_EQUAL( newCacheFiles.size(), 1 );
+	BOOST_CHECK( newCacheFiles[0] != cacheFiles[0] );
+	const string newMonoCache = readFile( newCacheFiles[0] );
+
+	// mismatched modification time
+	writeFile( newCacheFiles[0], monoCache );
+	buffer = load();
+	BOOST_REQUIRE_EQUAL( buffer->getNumChannels(), 1 );
+	BOOST_CHECK_EQUAL( maxError( *buffer, *expectedMono ), 0 );
+	BOOST_CHECK( readFile( newCacheFiles[0] ) == newMonoCache );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "utils.h"
+#include "cinder/audio2/SampleStore.h"
+#include "cinder/audio2/FileOggVorbis.h"
+#include "cinder/audio2/Exception.h"
+#include "cinder/DataSource.h"
+
+BOOST_AUTO_TEST_SUITE( test_sample_store )
+
+using namespace std;
+using namespace ci::audio2;
+
+// Reads in chunks that straddle decoded blocks, evicting every block between reads so that each one is decoded again from
+// wherever the read left off. The result must match decoding the file directly.
+BOOST_AUTO_TEST_CASE( test_decode_with_blocks_evicted )
+{
+	const auto path = getAssetPath( "tone440L220R.ogg" );
+
+	BufferRef expected = SourceFileImplOggVorbis( ci::loadFile( path ) ).loadBuffer();
+
+	auto store = SampleStore::create();
+	store->add( "tone", ci::loadFile( path ) );
+	SourceFileRef sourceFile = store->createSourceFile( "tone" );
+
+	BOOST_REQUIRE_EQUAL( sourceFile->getNumFrames(), expected->getNumFrames() );
+	BOOST_REQUIRE_EQUAL( sourceFile->getNumChannels(), expected->getNumChannels() );
+
+	const size_t capacity = store->getDecodedCacheCapacity();
+	Buffer result( sourceFile->getNumFrames(), sourceFile->getNumChannels() );
+	Buffer readBuffer( SampleStore::kBlockFrames / 3 + 1, sourceFile->getNumChannels() );
+
+	size_t readPos = 0;
+	while( readPos < result.getNumFrames() ) {
+		size_t numRead = sourceFile->read( &readBuffer );
+		BOOST_REQUIRE( numRead > 0 );
+
+		result.copyOffset( readBuffer, numRead, readPos, 0 );
+		readPos += numRead;
+
+		store->setDecodedCacheCapacity( 0 );
+		BOOST_CHECK_EQUAL( store->getNumDecodedBytes(), 0 );
+		store->setDecodedCacheCapacity( capacity );
+	}
+
+	BOOST_CHECK_EQUAL( readPos, expected->getNumFrames() );
+	BOOST_CHECK_SMALL( maxError( result, *expected ), ACCEPTABLE_FLOAT_ERROR );
+}
+
+BOOST_AUTO_TEST_CASE( test_add_rejects_non_ogg )
+{
+	auto store = SampleStore::create();
+
+	BOOST_CHECK_THROW( store->add( "wav", ci::loadFile( getAssetPath( "tone440.wav" ) ) ), AudioFileExc );
+	BOOST_CHECK( ! store->contains( "wav" ) );
+	BOOST_CHECK_EQUAL( store->getNumEncodedBytes(), 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
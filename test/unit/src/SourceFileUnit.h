@@ -0,0 +1,103 @@
+#pragma once
+
+#include "utils.h"
+#include "cinder/audio2/Source.h"
+
+BOOST_AUTO_TEST_SUITE( test_source_file )
+
+using namespace std;
+using namespace ci::audio2;
+
+namespace {
+
+// Generates a sine per channel instead of decoding a file, long enough for loadBuffer() to split it into segments. If
+// convertsItself is true, it provides its own channel conversion (but not samplerate conversion) by repeating the last native channel.
+class SourceFileSine : public SourceFile {
+  public:
+	SourceFileSine( size_t sampleRate, size_t numChannels, size_t numFrames, bool convertsItself = false )
+		: mConvertsItself( convertsItself ), mPos( 0 )
+	{
+		mSampleRate = mNativeSampleRate = sampleRate;
+		mNumChannels = mNativeNumChannels = numChannels;
+		mNumFrames = mFileNumFrames = numFrames;
+	}
+
+	SourceFileRef clone() const override	{ return make_shared<SourceFileSine>( mNativeSampleRate, mNativeNumChannels, mFileNumFrames, mConvertsItself ); }
+
+	static float calcSample( size_t ch, size_t frame, size_t sampleRate )
+	{
+		return sinf( 2.0f * float( M_PI ) * 100.0f * float( ch + 1 ) * float( frame ) / float( sampleRate ) );
+	}
+
+  protected:
+	size_t performRead( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded ) override
+	{
+		for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
+			float *channel = buffer->getChannel( ch ) + bufferFrameOffset;
+			for( size_t i = 0; i < numFramesNeeded; i++ )
+				channel[i] = calcSample( min( ch, mNativeNumChannels - 1 ), mPos + i, mNativeSampleRate );
+		}
+
+		mPos += numFramesNeeded;
+		return numFramesNeeded;
+	}
+
+	void performSeek( size_t readPositionFrames ) override	{ mPos = readPositionFrames; }
+	bool supportsConversion() override						{ return mConvertsItself; }
+
+  private:
+	bool	mConvertsItself;
+	size_t	mPos;
+};
+
+const size_t kNumFrames = 1100000; // 4 segments of at least 262144 frames
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE( test_load_segmented_native )
+{
+	SourceFileSine serialFile( 44100, 2, kNumFrames ), segmentedFile( 44100, 2, kNumFrames );
+
+	BufferRef serial = serialFile.loadBuffer();
+	BufferRef segmented = segmentedFile.loadBuffer( 4 );
+
+	BOOST_REQUIRE_EQUAL( segmented->getNumFrames(), serial->getNumFrames() );
+	BOOST_REQUIRE_EQUAL( segmented->getNumChannels(), serial->getNumChannels() );
+	BOOST_CHECK_EQUAL( maxError( *serial, *segmented ), 0.0f );
+}
+
+BOOST_AUTO_TEST_CASE( test_load_segmented_converted )
+{
+	SourceFileSine serialFile( 44100, 1, kNumFrames ), segmentedFile( 44100, 1, kNumFrames );
+	serialFile.setOutputFormat( 48000, 2 );
+	segmentedFile.setOutputFormat( 48000, 2 );
+
+	BufferRef serial = serialFile.loadBuffer();
+	BufferRef segmented = segmentedFile.loadBuffer( 4 );
+
+	BOOST_REQUIRE_EQUAL( segmented->getNumFrames(), serial->getNumFrames() );
+	BOOST_REQUIRE_EQUAL( segmented->getNumChannels(), serial->getNumChannels() );
+	BOOST_CHECK_SMALL( maxError( *serial, *segmented ), 0.0001f );
+}
+
+// A SourceFile that converts itself reads in the output format, which segments can't decode and convert separately.
+BOOST_AUTO_TEST_CASE( test_load_segmented_source_converts )
+{
+	SourceFileSine file( 44100, 1, kNumFrames, true );
+	file.setOutputFormat( 44100, 2 );
+
+	BufferRef buffer = file.loadBuffer( 4 );
+
+	BOOST_REQUIRE_EQUAL( buffer->getNumFrames(), kNumFrames );
+	BOOST_REQUIRE_EQUAL( buffer->getNumChannels(), 2 );
+
+	float error = 0;
+	for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
+		for( size_t i = 0; i < buffer->getNumFrames(); i++ )
+			error = max( error, fabsf( buffer->getChannel( ch )[i] - SourceFileSine::calcSample( 0, i, 44100 ) ) );
+	}
+
+	BOOST_CHECK_EQUAL( error, 0.0f );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
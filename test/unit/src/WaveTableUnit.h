@@ -0,0 +1,105 @@
+#pragma once
+
+#include "utils.h"
+#include "cinder/audio2/dsp/WaveTable.h"
+
+#include <iostream>
+#include <cmath>
+
+BOOST_AUTO_TEST_SUITE( test_wavetable )
+
+using namespace ci::audio2;
+
+// fillSine() is synthesized with an inverse FFT for power of two sizes, so this verifies both the scale and the phase of the generated partials.
+BOOST_AUTO_TEST_CASE( test_fill_sine )
+{
+	const size_t tableSize = 1024;
+	dsp::WaveTable waveTable( 44100, tableSize );
+	waveTable.fillSine();
+
+	std::vector<float> table( tableSize );
+	waveTable.copyTo( table.data() );
+
+	float maxErr = 0;
+	for( size_t i = 0; i < tableSize; i++ ) {
+		float expected = (float)std::sin( 2.0 * M_PI * i / (double)tableSize );
+		maxErr = std::max( maxErr, std::fabs( table[i] - expected ) );
+	}
+
+	std::cout << "\tWaveTable::fillSine max error: " << maxErr << std::endl;
+	BOOST_CHECK( maxErr < 1e-5f );
+}
+
+// the fixed-point lookup kernels should track an ideal sine over many cycles, both with a constant frequency and a per-sample frequency array.
+BOOST_AUTO_TEST_CASE( test_lookup )
+{
+	const size_t sampleRate = 44100;
+	const size_t length = 10007; // not a multiple of the vector width
+	const float freq = 440;
+
+	dsp::WaveTable waveTable( sampleRate, 4096 );
+	waveTable.fillSine();
+
+	std::vector<float> output( length ), outputArray( length ), freqArray( length, freq );
+	float phase = waveTable.lookup( output.data(), length, 0.25f, freq );
+	float phaseArray = waveTable.lookup( outputArray.data(), length, 0.25f, freqArray.data() );
+
+	float maxErr = 0, maxErrArray = 0;
+	for( size_t i = 0; i < length; i++ ) {
+		double expected = std::sin( 2.0 * M_PI * ( 0.25 + (double)freq * i / sampleRate ) );
+		maxErr = std::max( maxErr, (float)std::fabs( output[i] - expected ) );
+		maxErrArray = std::max( maxErrArray, (float)std::fabs( outputArray[i] - expected ) );
+	}
+
+	double expectedPhase = 0.25 + (double)freq * length / sampleRate;
+	expectedPhase -= std::floor( expectedPhase );
+
+	std::cout << "\tWaveTable::lookup max error: " << maxErr << ", with freq array: " << maxErrArray << std::endl;
+	BOOST_CHECK( maxErr < 1e-4f );
+	BOOST_CHECK( maxErrArray < 1e-3f );
+	BOOST_CHECK_SMALL( phase - expectedPhase, 1e-5 );
+	BOOST_CHECK_SMALL( phaseArray - expectedPhase, 1e-5 );
+}
+
+// selecting a bandlimited table per-sample should match selecting it once when the frequency is constant.
+BOOST_AUTO_TEST_CASE( test_lookup_bandlimited )
+{
+	const size_t length = 1031;
+	auto waveTable = dsp::WaveTableCache::getBandlimited( WaveformType::SAWTOOTH, 44100, 2048, 40 );
+
+	const float freqs[] = { 10, 55, 440, 1234, 5000, 15000 };
+	for( float freq : freqs ) {
+		std::vector<float> output( length ), outputArray( length ), freqArray( length, freq );
+		waveTable->lookupBandlimited( output.data(), length, 0, freq );
+		waveTable->lookupBandlimited( outputArray.data(), length, 0, freqArray.data() );
+
+		float maxErr = 0;
+		for( size_t i = 0; i < length; i++ )
+			maxErr = std::max( maxErr, std::fabs( output[i] - outputArray[i] ) );
+
+		BOOST_CHECK_MESSAGE( maxErr < 1e-3f, "freq: " << freq << ", max error: " << maxErr );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_cache_shares_tables )
+{
+	const size_t numCachedBefore = dsp::WaveTableCache::getNumCachedTables();
+	{
+		auto saw1 = dsp::WaveTableCache::getBandlimited( WaveformType::SAWTOOTH, 44100, 1024, 8 );
+		auto saw2 = dsp::WaveTableCache::getBandlimited( WaveformType::SAWTOOTH, 44100, 1024, 8 );
+		auto saw1000 = dsp::WaveTableCache::getBandlimited( WaveformType::SAWTOOTH, 44100, 1000, 8 ); // rounded up to 1024
+		auto square = dsp::WaveTableCache::getBandlimited( WaveformType::SQUARE, 44100, 1024, 8 );
+		auto saw48k = dsp::WaveTableCache::getBandlimited( WaveformType::SAWTOOTH, 48000, 1024, 8 );
+
+		BOOST_CHECK( saw1 == saw2 );
+		BOOST_CHECK( saw1 == saw1000 );
+		BOOST_CHECK( saw1 != square );
+		BOOST_CHECK( saw1 != saw48k );
+		BOOST_CHECK_EQUAL( dsp::WaveTableCache::getNumCachedTables(), numCachedBefore + 3 );
+	}
+
+	// all references released, so the tables should be freed
+	BOOST_CHECK_EQUAL( dsp::WaveTableCache::getNumCachedTables(), numCachedBefore );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "utils.h"
+#include "cinder/audio2/dsp/Yin.h"
+
+#include <iostream>
+#include <cmath>
+
+BOOST_AUTO_TEST_SUITE( test_yin )
+
+using namespace ci::audio2;
+
+namespace {
+
+	// sawtooth-like signal with three harmonics, so the fundamental isn't the only peak in the autocorrelation
+	void fillHarmonic( Buffer *buffer, float freq, float sampleRate )
+	{
+		for( size_t i = 0; i < buffer->getNumFrames(); i++ ) {
+			float phase = 2 * float( M_PI ) * freq * i / sampleRate;
+			(*buffer)[i] = 0.5f * std::sin( phase ) + 0.25f * std::sin( 2 * phase ) + 0.125f * std::sin( 3 * phase );
+		}
+	}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_detect_harmonic )
+{
+	const float sampleRate = 44100;
+	const float freqs[] = { 55, 110, 261.63f, 440, 1000, 2500 };
+
+	dsp::Yin yin( 2048 );
+	Buffer window( yin.getWindowSize() );
+
+	for( float freq : freqs ) {
+		fillHarmonic( &window, freq, sampleRate );
+
+		float period = yin.detectPeriod( window.getData() );
+		BOOST_REQUIRE( period > 0 );
+
+		float detectedFreq = sampleRate / period;
+		float err = std::fabs( detectedFreq - freq ) / freq;
+		std::cout << "\tfreq: " << freq << ", detected: " << detectedFreq << ", confidence: " << yin.getConfidence() << std::endl;
+
+		BOOST_CHECK_MESSAGE( err < 0.005f, "detected frequency off by more than 0.5%" );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_unvoiced )
+{
+	dsp::Yin yin( 1024 );
+	Buffer window( yin.getWindowSize() );
+
+	BOOST_CHECK_EQUAL( yin.detectPeriod( window.getData() ), 0 );
+
+	fillRandom( &window );
+	BOOST_CHECK_EQUAL( yin.detectPeriod( window.getData() ), 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,14 @@
 // the single header variant of Boost Test cannot handle multiple .cpp's,
 // so they are included as headers.
 
+#include "BiquadBankUnit.h"
 #include "BufferUnit.h"
+#include "DspUnit.h"
 #include "FftUnit.h"
-#include "RingbufferUnit.h"
\ No newline at end of file
+#include "ParamUnit.h"
+#include "RingbufferUnit.h"
+#include "SampleLibraryUnit.h"
+#include "SampleStoreUnit.h"
+#include "SourceFileUnit.h"
+#include "WaveTableUnit.h"
+#include "YinUnit.h"
\ No newline at end of file
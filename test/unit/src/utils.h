@@ -3,6 +3,7 @@
 #include "cinder/audio2/Buffer.h"
 #include "cinder/audio2/CinderAssert.h"
 #include "cinder/Rand.h"
+#include "cinder/Filesystem.h"
 
 #define ACCEPTABLE_FLOAT_ERROR 0.000001f 
 
@@ -21,4 +22,10 @@ float maxError( const ci::audio2::Buffer &a, const ci::audio2::Buffer &b )
 		error = std::max( error, std::fabs( a[i] - b[i]) );
 
 	return error;
-}
\ No newline at end of file
+}
+
+// The unit tests don't run as an app with assets, so the repository's assets folder is found relative to this file.
+ci::fs::path getAssetPath( const std::string &fileName )
+{
+	return ci::fs::path( __FILE__ ).parent_path() / ".." / ".." / ".." / "assets" / fileName;
+}